@@ -0,0 +1,148 @@
+// Spawning and despawning bodies: cost of add and remove by handle on a
+// large world, heap allocations once warmed up (expected zero), and a
+// check that live handles find their bodies and removed ones find nothing,
+// including handles to a slot that has since been reused many times.
+// Usage: physica_churn_bench [--bodies N] [--churn N] [--rounds N]
+#include "PhysicsEngine.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <random>
+#include <vector>
+
+using namespace Physica;
+
+namespace {
+
+size_t allocationCount = 0;
+
+} // namespace
+
+// Counts every heap allocation in the process
+void* operator new(std::size_t size) {
+    ++allocationCount;
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Tracked {
+    BodyHandle handle;
+    float id;  // Stored as the body's x coordinate
+};
+
+// Bodies on a grid, their x coordinate unique so a handle can be checked
+PhysicsObject makeBody(float id) {
+    PhysicsObject obj(Vector2D(id, static_cast<float>(static_cast<int>(id) % 997)), 1.0f);
+    obj.radius = 2.0f;
+    return obj;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t count = 100000;
+    size_t churn = 2000;  // Bodies replaced per round
+    int rounds = 200;
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (std::strcmp(argv[i], "--bodies") == 0) {
+            count = std::strtoul(argv[i + 1], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--churn") == 0) {
+            churn = std::strtoul(argv[i + 1], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--rounds") == 0) {
+            rounds = std::atoi(argv[i + 1]);
+        } else {
+            std::fprintf(stderr, "Unknown option %s\n", argv[i]);
+            return 1;
+        }
+    }
+    churn = std::min(churn, count);
+
+    PhysicsEngine engine;
+    std::vector<Tracked> live;
+    std::vector<BodyHandle> removed;
+    live.reserve(count);
+    removed.reserve(churn * (rounds + 1));
+    float nextId = 0.0f;
+    for (size_t i = 0; i < count; ++i) {
+        size_t index = engine.addObject(makeBody(nextId));
+        live.push_back({engine.getHandle(index), nextId++});
+    }
+
+    // Each round despawns `churn` random bodies by handle and spawns as
+    // many; the first round warms up the free list
+    std::mt19937 rng(7);
+    double seconds = 0.0;
+    size_t allocations = 0;
+    for (int round = 0; round <= rounds; ++round) {
+        size_t before = allocationCount;
+        auto start = Clock::now();
+        for (size_t k = 0; k < churn; ++k) {
+            size_t pick = rng() % live.size();
+            engine.removeObject(live[pick].handle);
+            removed.push_back(live[pick].handle);
+            live[pick] = live.back();
+            live.pop_back();
+        }
+        for (size_t k = 0; k < churn; ++k) {
+            size_t index = engine.addObject(makeBody(nextId));
+            live.push_back({engine.getHandle(index), nextId++});
+        }
+        if (round > 0) {
+            seconds += std::chrono::duration<double>(Clock::now() - start).count();
+            // The tracking vectors were reserved up front, so every
+            // allocation here comes from the engine
+            allocations += allocationCount - before;
+        }
+    }
+
+    const double operations = 2.0 * churn * rounds;
+    std::printf("%zu bodies, %zu despawned and spawned per round, %d rounds\n", count, churn, rounds);
+    std::printf("%.1f ns per add or remove (%.1f M per second), %zu heap allocations after warm-up\n",
+                seconds / operations * 1e9, operations / seconds * 1e-6, allocations);
+
+    bool ok = engine.getObjectCount() == count && allocations == 0;
+    for (const Tracked& body : live) {
+        std::optional<size_t> index = engine.findObject(body.handle);
+        ok = ok && index && engine.getBodies().position[*index].x == body.id;
+    }
+    // Despawn and respawn one body over and over: the free list hands the
+    // same slot back every time, far more often than any round reuses it
+    const size_t reuses = 100000;
+    removed.reserve(removed.size() + reuses);
+    for (size_t k = 0; k < reuses; ++k) {
+        engine.removeObject(live.back().handle);
+        removed.push_back(live.back().handle);
+        size_t index = engine.addObject(makeBody(nextId));
+        live.back() = {engine.getHandle(index), nextId++};
+    }
+    std::optional<size_t> last = engine.findObject(live.back().handle);
+    ok = ok && last && engine.getBodies().position[*last].x == live.back().id;
+
+    size_t resolved = 0;
+    for (BodyHandle handle : removed) {
+        resolved += engine.findObject(handle).has_value();
+    }
+    std::printf("%zu live handles checked, %zu of %zu removed handles still resolve (%zu from one reused slot)\n",
+                live.size(), resolved, removed.size(), reuses);
+    if (!ok || resolved > 0) {
+        std::printf("FAILED\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,73 @@
+// Compares the brute-force pair loop against the uniform grid broadphase
+// over a range of body counts at constant density and reports the crossover.
+#include "PhysicsEngine.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+using namespace Physica;
+
+namespace {
+
+// Average area per body in square pixels (keeps density constant as N grows)
+constexpr float kAreaPerBody = 60.0f * 60.0f;
+
+void fillScene(PhysicsEngine& engine, size_t count, unsigned seed) {
+    std::mt19937 rng(seed);
+    float side = std::sqrt(kAreaPerBody * count);
+    std::uniform_real_distribution<float> coord(0.0f, side);
+    std::uniform_real_distribution<float> radius(5.0f, 15.0f);
+
+    engine.clearObjects();
+    for (size_t i = 0; i < count; ++i) {
+        PhysicsObject obj(Vector2D(coord(rng), coord(rng)), 10.0f);
+        obj.radius = radius(rng);
+        engine.addObject(obj);
+    }
+}
+
+// Average nanoseconds per handleCollisions() call
+double timeCollisions(BroadphaseMethod method, size_t count) {
+    PhysicsEngine engine;
+    engine.setBroadphaseMethod(method);
+    fillScene(engine, count, 1234);
+
+    using Clock = std::chrono::steady_clock;
+    int iterations = 0;
+    auto start = Clock::now();
+    auto elapsed = Clock::duration::zero();
+    while (iterations < 3 || elapsed < std::chrono::milliseconds(200)) {
+        engine.handleCollisions();
+        ++iterations;
+        elapsed = Clock::now() - start;
+    }
+    return std::chrono::duration<double, std::nano>(elapsed).count() / iterations;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t maxCount = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 12800;
+
+    std::printf("%10s %16s %16s %10s\n", "bodies", "brute (us)", "grid (us)", "speedup");
+
+    size_t crossover = 0;
+    for (size_t count = 25; count <= maxCount; count *= 2) {
+        double brute = timeCollisions(BroadphaseMethod::BruteForce, count);
+        double grid = timeCollisions(BroadphaseMethod::UniformGrid, count);
+        std::printf("%10zu %16.2f %16.2f %9.2fx\n", count, brute / 1000.0, grid / 1000.0, brute / grid);
+
+        if (crossover == 0 && grid < brute) {
+            crossover = count;
+        }
+    }
+
+    if (crossover > 0) {
+        std::printf("Grid is faster from %zu bodies\n", crossover);
+    } else {
+        std::printf("Grid never beat brute force in this range\n");
+    }
+    return 0;
+}
@@ -0,0 +1,126 @@
+// Continuous collision: bullets fired at a thin wall of static circles,
+// counting how many tunnel through with discrete collisions, with
+// discrete collisions at smaller steps, and with swept time of impact.
+// Fails if any bullet tunnels with continuous collision on.
+// Usage: physica_ccd_bench [--bullets N] [--speed S] [--substeps N]
+#include "PhysicsEngine.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+
+using namespace Physica;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr float kStep = 1.0f / 60.0f;
+constexpr float kWallX = 1000.0f;
+constexpr float kWallRadius = 4.0f;
+constexpr float kWorldSize = 2000.0f;
+constexpr size_t kBulletsPerRow = 10;
+
+struct Result {
+    size_t tunneled;
+    double msPerSecond;  // Wall time per simulated second
+};
+
+void buildScene(PhysicsEngine& engine, size_t bullets, float speed) {
+    engine.setBounds(kWorldSize, kWorldSize);
+    engine.gravityEnabled = false;
+    engine.airResistanceCoefficient = 0.0f;
+    engine.sleepingEnabled = false;
+
+    // A column of overlapping static circles from the floor to the
+    // ceiling, so bullets can only get past by going through it. The
+    // world's walls push bodies back at the start of the next step, so the
+    // column runs on past them by one step's travel
+    const float margin = speed * kStep;
+    for (float y = -margin; y <= kWorldSize + margin; y += kWallRadius) {
+        PhysicsObject post(Vector2D(kWallX, y), 1.0f);
+        post.radius = kWallRadius;
+        post.isStatic = true;
+        engine.addObject(post);
+    }
+    // Rows of kBulletsPerRow bullets, each row at its own speed up to
+    // `speed` so bullets in a row never catch each other up
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<float> fraction(0.25f, 1.0f);
+    const size_t rows = (bullets + kBulletsPerRow - 1) / kBulletsPerRow;
+    float rowSpeed = 0.0f;
+    for (size_t i = 0; i < bullets; ++i) {
+        size_t row = i / kBulletsPerRow;
+        if (i % kBulletsPerRow == 0) {
+            rowSpeed = speed * fraction(rng);
+        }
+        float x = 100.0f + 40.0f * (i % kBulletsPerRow);
+        float y = kWorldSize * (row + 0.5f) / rows;
+        PhysicsObject bullet(Vector2D(x, y), 0.1f);
+        bullet.radius = 1.0f;
+        bullet.velocity = Vector2D(rowSpeed, 0.0f);
+        bullet.previousPosition = bullet.position - bullet.velocity * kStep;
+        bullet.restitution = 0.5f;
+        engine.addObject(bullet);
+    }
+}
+
+Result run(size_t bullets, float speed, int substeps, bool continuous) {
+    PhysicsEngine engine;
+    engine.continuousCollisionEnabled = continuous;
+    buildScene(engine, bullets, speed);
+
+    const int steps = 60 * substeps;  // One simulated second
+    auto start = Clock::now();
+    engine.step(steps, kStep / substeps);
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    Result result{0, seconds * 1e3};
+    const BodyStorage& bodies = engine.getBodies();
+    for (size_t i = 0; i < bodies.size(); ++i) {
+        if (bodies.invMass[i] > 0.0f && bodies.position[i].x > kWallX) {
+            ++result.tunneled;
+        }
+    }
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t bullets = 2000;
+    float speed = 12000.0f;
+    int substeps = 8;
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (std::strcmp(argv[i], "--bullets") == 0) {
+            bullets = std::strtoul(argv[i + 1], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--speed") == 0) {
+            speed = std::strtof(argv[i + 1], nullptr);
+        } else if (std::strcmp(argv[i], "--substeps") == 0) {
+            substeps = std::atoi(argv[i + 1]);
+        } else {
+            std::fprintf(stderr, "Unknown option %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    std::printf("%zu bullets at up to %.0f px/s against a wall of %.0f px circles\n", bullets, speed,
+                2.0f * kWallRadius);
+    std::printf("%-28s %10s %16s\n", "mode", "tunneled", "ms per sim s");
+    Result discrete = run(bullets, speed, 1, false);
+    std::printf("%-28s %10zu %16.2f\n", "discrete", discrete.tunneled, discrete.msPerSecond);
+    Result fine = run(bullets, speed, substeps, false);
+    char label[64];
+    std::snprintf(label, sizeof(label), "discrete, %d substeps", substeps);
+    std::printf("%-28s %10zu %16.2f\n", label, fine.tunneled, fine.msPerSecond);
+    Result swept = run(bullets, speed, 1, true);
+    std::printf("%-28s %10zu %16.2f\n", "continuous", swept.tunneled, swept.msPerSecond);
+
+    if (swept.tunneled > 0) {
+        std::printf("FAILED\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,90 @@
+// Stress test for the graph-coloured contact solver.
+// Builds a packed pile with 50k+ contacts and times the serial and batched
+// paths. tests/ContactSolverTest.cpp checks batches against serial.
+#include "ContactSolver.h"
+#include "Broadphase.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+using namespace Physica;
+
+namespace {
+
+// Hexagonal packing with slight overlap gives about three contacts per body
+BodyStorage buildPile(size_t columns, size_t rows) {
+    const float radius = 5.0f;
+    const float spacing = 1.9f * radius;
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> jitter(-20.0f, 20.0f);
+
+    BodyStorage bodies;
+    bodies.reserve(columns * rows + columns);
+    for (size_t row = 0; row < rows; ++row) {
+        for (size_t col = 0; col < columns; ++col) {
+            float x = col * spacing + (row % 2) * spacing * 0.5f;
+            float y = row * spacing * 0.866f;
+            PhysicsObject obj(Vector2D(x, y), 1.0f + (col + row) % 5);
+            obj.radius = radius;
+            obj.velocity = Vector2D(jitter(rng), jitter(rng));
+            bodies.add(obj);
+        }
+    }
+    // Static floor under the pile
+    for (size_t col = 0; col < columns; ++col) {
+        PhysicsObject floor(Vector2D(col * spacing, rows * spacing * 0.866f), 1.0f);
+        floor.radius = radius;
+        floor.isStatic = true;
+        bodies.add(floor);
+    }
+    return bodies;
+}
+
+template <typename Fn>
+double timeMs(int iterations, Fn&& fn) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) fn();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / iterations;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t side = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 140;
+    size_t threads = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 0;
+
+    const BodyStorage pile = buildPile(side, side);
+    ThreadPool serialPool(1);
+    ThreadPool parallelPool(threads);
+
+    UniformGridBroadphase grid;
+    std::vector<BodyPair> candidates;
+    grid.findPairs(pile, candidates);
+
+    ContactSolver solver;
+    solver.findContacts(pile, candidates, serialPool);
+    solver.buildBatches(pile);
+    std::printf("bodies %zu, contacts %zu, colour batches %zu, threads %zu\n",
+                pile.size(), solver.getContacts().size(), solver.getBatchCount(),
+                parallelPool.getThreadCount());
+
+    // Timing: restore the pile before each solve
+    const int iterations = 10;
+    BodyStorage work = pile;
+    double serialMs = timeMs(iterations, [&] {
+        work = pile;
+        solver.solveSerial(work);
+    });
+    double batchedMs = timeMs(iterations, [&] {
+        work = pile;
+        solver.solveBatches(work, parallelPool);
+    });
+    double copyMs = timeMs(iterations, [&] { work = pile; });
+    serialMs -= copyMs;
+    batchedMs -= copyMs;
+
+    std::printf("serial %.3f ms, batched %.3f ms, speedup %.2fx\n", serialMs, batchedMs, serialMs / batchedMs);
+    return 0;
+}
@@ -0,0 +1,294 @@
+// Integrator accuracy against cost: the projectile, elastic collision and
+// harmonic motion scenes of the app, stepped headless with every
+// IntegrationMethod over a sweep of time steps. Friction, drag and walls
+// are off so the exact solutions apply. Each run reports the largest
+// position error against the exact solution, the largest drift of
+// getTotalEnergy from its starting value (relative), and wall time per step,
+// per body-step and per body per simulated second. Every scene is copied
+// `copies` times so the per-body cost outweighs the per-step overhead; each
+// copy is checked against its own exact solution. The cost that counts is
+// per simulated second, since a smaller step needs more of them: a run is
+// on the Pareto front when no other run of the same scene has both a
+// smaller error and a lower cost. Output is CSV, sorted by scene and cost.
+// Usage: physica_integrator_bench [--copies N] [--seconds S] [--csv PATH]
+#include "PhysicsEngine.h"
+#include "Scenes.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+using namespace Physica;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+enum class SceneId {
+    Projectile,
+    ElasticCollisions,
+    HarmonicMotion
+};
+
+struct SceneInfo {
+    SceneId id;
+    const char* name;
+    void (*add)(PhysicsEngine& engine);
+};
+
+const SceneInfo kScenes[] = {
+    {SceneId::Projectile, "projectile", addProjectileMotionScene},
+    {SceneId::ElasticCollisions, "elastic_collisions", addElasticCollisionsScene},
+    {SceneId::HarmonicMotion, "harmonic_motion", addHarmonicMotionScene},
+};
+
+struct MethodInfo {
+    IntegrationMethod method;
+    const char* name;
+};
+
+const MethodInfo kMethods[] = {
+    {IntegrationMethod::Euler, "euler"},
+    {IntegrationMethod::SemiImplicitEuler, "semi_implicit_euler"},
+    {IntegrationMethod::Verlet, "verlet"},
+    {IntegrationMethod::VelocityVerlet, "velocity_verlet"},
+    {IntegrationMethod::Rk4, "rk4"},
+    {IntegrationMethod::Xpbd, "xpbd"},
+};
+
+const int kStepRates[] = {15, 30, 60, 120, 240, 480, 960};  // Steps per second
+
+struct Row {
+    const char* scene;
+    const char* method;
+    int rate;
+    size_t steps;
+    size_t bodies;
+    double error;        // Largest distance from the exact position, pixels
+    double energyDrift;  // Largest |E - E0| / |E0|
+    double nsPerStep;
+    double nsPerBodyStep;
+    double nsPerBodySecond;  // Per simulated second
+    bool pareto = false;
+};
+
+// Starting state of one body, all the exact solutions need
+struct Start {
+    Vector2D position;
+    Vector2D velocity;
+    float radius;
+    float mass;
+};
+
+// Exact position at time t under constant gravity g and, with stiffness k,
+// a spring pulling towards `anchor`
+Vector2D exactFree(const Start& start, const Vector2D& g, const Vector2D& anchor, double k, double t) {
+    if (k == 0.0) {
+        return Vector2D(static_cast<float>(start.position.x + start.velocity.x * t + 0.5 * g.x * t * t),
+                        static_cast<float>(start.position.y + start.velocity.y * t + 0.5 * g.y * t * t));
+    }
+    // Oscillation about the point where the spring balances gravity
+    const double omega = std::sqrt(k);
+    const double c = std::cos(omega * t);
+    const double s = std::sin(omega * t) / omega;
+    const double restX = anchor.x + g.x / k;
+    const double restY = anchor.y + g.y / k;
+    return Vector2D(static_cast<float>(restX + (start.position.x - restX) * c + start.velocity.x * s),
+                    static_cast<float>(restY + (start.position.y - restY) * c + start.velocity.y * s));
+}
+
+// Exact positions at time t of two bodies meeting head on in a perfectly
+// elastic collision, under constant gravity g
+void exactPair(const Start& a, const Start& b, const Vector2D& g, double t, Vector2D& outA, Vector2D& outB) {
+    Vector2D normal = (b.position - a.position).normalized();
+    const double closing = (a.velocity - b.velocity).dot(normal);
+    const double gap = (b.position - a.position).magnitude() - a.radius - b.radius;
+    Vector2D velocityA = a.velocity;
+    Vector2D velocityB = b.velocity;
+    double contact = t;
+    if (closing > 0.0 && gap / closing < t) {
+        contact = gap / closing;
+    }
+    Vector2D positionA = a.position + a.velocity * static_cast<float>(contact);
+    Vector2D positionB = b.position + b.velocity * static_cast<float>(contact);
+    if (contact < t) {
+        // Swap normal momenta as a 1D elastic collision does
+        const double total = a.mass + b.mass;
+        const double normalA = a.velocity.dot(normal);
+        const double normalB = b.velocity.dot(normal);
+        const double afterA = ((a.mass - b.mass) * normalA + 2.0 * b.mass * normalB) / total;
+        const double afterB = ((b.mass - a.mass) * normalB + 2.0 * a.mass * normalA) / total;
+        velocityA += normal * static_cast<float>(afterA - normalA);
+        velocityB += normal * static_cast<float>(afterB - normalB);
+        positionA += velocityA * static_cast<float>(t - contact);
+        positionB += velocityB * static_cast<float>(t - contact);
+    }
+    const Vector2D fall = g * static_cast<float>(0.5 * t * t);
+    outA = positionA + fall;
+    outB = positionB + fall;
+}
+
+Row run(const SceneInfo& scene, const MethodInfo& method, int rate, size_t copies, float seconds) {
+    PhysicsEngine engine;
+    engine.setIntegrationMethod(method.method);
+    engine.airResistanceCoefficient = 0.0f;
+    engine.boundaryEnabled = false;
+    engine.sleepingEnabled = false;
+    // Only the elastic scene's bodies meet; the others' copies overlap
+    engine.collisionsEnabled = scene.id == SceneId::ElasticCollisions;
+    scene.add(engine);
+
+    // Copies of the scene: elastic pairs in rows apart, the rest nearly on
+    // top of the original so every copy moves much like it
+    BodyStorage& bodies = engine.getBodies();
+    const size_t perCopy = bodies.size();
+    for (size_t copy = 1; copy < copies; ++copy) {
+        Vector2D offset = scene.id == SceneId::ElasticCollisions
+                              ? Vector2D(0.0f, 50.0f * copy)
+                              : Vector2D(2.0f * (copy % 16), 2.0f * (copy / 16));
+        for (size_t i = 0; i < perCopy; ++i) {
+            PhysicsObject object = bodies.toObject(i);
+            object.position += offset;
+            engine.addObject(object);
+        }
+    }
+
+    const float dt = 1.0f / rate;
+    const Vector2D g = engine.gravityEnabled ? engine.getGravity() : Vector2D(0, 0);
+    const std::vector<SpringField>& springs = engine.getForceFields().get<SpringField>();
+    const Vector2D anchor = springs.empty() ? Vector2D(0, 0) : springs.front().anchor;
+    const double stiffness = springs.empty() ? 0.0 : springs.front().stiffness;
+
+    std::vector<Start> starts(bodies.size());
+    for (size_t i = 0; i < bodies.size(); ++i) {
+        bodies.friction[i] = 0.0f;
+        starts[i] = {bodies.position[i], bodies.velocity[i], bodies.radius[i], bodies.mass[i]};
+        // Verlet's velocity is the average over the last step, so it starts
+        // with the velocity half a step back
+        if (method.method == IntegrationMethod::Verlet) {
+            const Vector2D acceleration =
+                g + engine.getForceFields().force(bodies.position[i], bodies.mass[i]) * bodies.invMass[i];
+            bodies.velocity[i] -= acceleration * (0.5f * dt);
+            bodies.previousPosition[i] = bodies.position[i] - bodies.velocity[i] * dt;
+        }
+    }
+
+    Row row{scene.name, method.name, rate, 0, bodies.size(), 0.0, 0.0, 0.0, 0.0, 0.0};
+    row.steps = static_cast<size_t>(std::lround(seconds * rate));
+    const double startEnergy = engine.getTotalEnergy();
+    double elapsed = 0.0;
+    for (size_t step = 1; step <= row.steps; ++step) {
+        auto start = Clock::now();
+        engine.step(1, dt);
+        elapsed += std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+
+        const double t = step * static_cast<double>(dt);
+        for (size_t i = 0; i < bodies.size(); ++i) {
+            Vector2D exact;
+            if (scene.id == SceneId::ElasticCollisions) {
+                size_t first = i - i % 2;
+                Vector2D exactA, exactB;
+                exactPair(starts[first], starts[first + 1], g, t, exactA, exactB);
+                exact = i % 2 == 0 ? exactA : exactB;
+            } else {
+                exact = exactFree(starts[i], g, anchor, stiffness, t);
+            }
+            row.error = std::max(row.error, double((bodies.position[i] - exact).magnitude()));
+        }
+        const double drift = std::fabs(engine.getTotalEnergy() - startEnergy) / std::fabs(startEnergy);
+        row.energyDrift = std::max(row.energyDrift, drift);
+    }
+    row.nsPerStep = elapsed / row.steps;
+    row.nsPerBodyStep = row.nsPerStep / bodies.size();
+    row.nsPerBodySecond = row.nsPerBodyStep * rate;
+    return row;
+}
+
+// A row is dominated when another row of its scene is no worse in error and
+// cost and better in one
+void markPareto(std::vector<Row>& rows) {
+    for (Row& row : rows) {
+        row.pareto = true;
+        for (const Row& other : rows) {
+            if (std::strcmp(other.scene, row.scene) != 0) continue;
+            bool noWorse = other.error <= row.error && other.nsPerBodySecond <= row.nsPerBodySecond;
+            bool better = other.error < row.error || other.nsPerBodySecond < row.nsPerBodySecond;
+            if (noWorse && better) {
+                row.pareto = false;
+                break;
+            }
+        }
+    }
+}
+
+void writeCsv(FILE* out, const std::vector<Row>& rows) {
+    std::fprintf(out, "scene,method,dt,steps,bodies,max_error_px,energy_drift,ns_per_step,ns_per_body_step,"
+                      "ns_per_body_second,pareto\n");
+    for (const Row& r : rows) {
+        std::fprintf(out, "%s,%s,1/%d,%zu,%zu,%.6g,%.6g,%.1f,%.2f,%.0f,%d\n", r.scene, r.method, r.rate, r.steps,
+                     r.bodies, r.error, r.energyDrift, r.nsPerStep, r.nsPerBodyStep, r.nsPerBodySecond,
+                     r.pareto ? 1 : 0);
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t copies = 256;
+    float seconds = 2.0f;
+    const char* csvPath = nullptr;
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (std::strcmp(argv[i], "--copies") == 0) {
+            copies = std::max<size_t>(1, std::strtoul(argv[i + 1], nullptr, 10));
+        } else if (std::strcmp(argv[i], "--seconds") == 0) {
+            seconds = std::strtof(argv[i + 1], nullptr);
+        } else if (std::strcmp(argv[i], "--csv") == 0) {
+            csvPath = argv[i + 1];
+        } else {
+            std::fprintf(stderr, "Unknown option %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    std::vector<Row> rows;
+    for (const SceneInfo& scene : kScenes) {
+        for (const MethodInfo& method : kMethods) {
+            for (int rate : kStepRates) {
+                rows.push_back(run(scene, method, rate, copies, seconds));
+            }
+        }
+    }
+    markPareto(rows);
+    std::stable_sort(rows.begin(), rows.end(), [](const Row& a, const Row& b) {
+        int scene = std::strcmp(a.scene, b.scene);
+        return scene != 0 ? scene < 0 : a.nsPerBodySecond < b.nsPerBodySecond;
+    });
+
+    if (!csvPath) {
+        writeCsv(stdout, rows);
+        return 0;
+    }
+    FILE* out = std::fopen(csvPath, "w");
+    if (!out) {
+        std::fprintf(stderr, "Cannot write %s\n", csvPath);
+        return 1;
+    }
+    writeCsv(out, rows);
+    std::fclose(out);
+
+    // The front on the console, cheapest first
+    std::printf("%-20s %-20s %6s %14s %14s %14s\n", "scene", "method", "dt", "max error px", "energy drift",
+                "ns/body/sim s");
+    for (const Row& r : rows) {
+        if (!r.pareto) continue;
+        char dt[16];
+        std::snprintf(dt, sizeof(dt), "1/%d", r.rate);
+        std::printf("%-20s %-20s %6s %14.3g %14.3g %14.0f\n", r.scene, r.method, dt, r.error, r.energyDrift,
+                    r.nsPerBodySecond);
+    }
+    return 0;
+}
@@ -0,0 +1,179 @@
+// Barnes-Hut mutual gravity: tree build and walk cost from 1k to 1M bodies,
+// with the force error against the exact pairwise sum.
+// Usage: physica_nbody_bench [--max N] [--theta T] [--threads N] [--samples N]
+// The direct sum is run in full up to 16k bodies; beyond that its cost is
+// extrapolated from the sampled bodies used for the error.
+#include "BarnesHutGravity.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+using namespace Physica;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double elapsedMs(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+constexpr size_t kMaxFullDirect = 16000;
+
+// Exponential disc of bodies with mixed masses, denser towards the center
+void buildDisc(BodyStorage& bodies, size_t count) {
+    const float scaleLength = 1000.0f;
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<float> unit(0.0001f, 1.0f);
+    std::uniform_real_distribution<float> mass(1.0f, 5.0f);
+
+    bodies.clear();
+    bodies.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        float r = -scaleLength * std::log(unit(rng));
+        float angle = 6.2831853f * unit(rng);
+        PhysicsObject obj(Vector2D(r * std::cos(angle), r * std::sin(angle)), mass(rng));
+        bodies.add(obj);
+    }
+}
+
+void clearForces(BodyStorage& bodies) {
+    std::fill(bodies.force.begin(), bodies.force.end(), Vector2D(0, 0));
+}
+
+struct Accuracy {
+    double rmsError = 0.0;  // RMS force error over RMS force
+    double maxError = 0.0;  // Worst relative error of one body
+    double directMs = 0.0;  // Time of the sampled exact sums
+    size_t sampled = 0;
+};
+
+// Compares the forces currently in `bodies` with exact sums on a sample
+Accuracy measureAccuracy(const BodyStorage& bodies, const BarnesHutGravity& gravity, size_t samples) {
+    Accuracy accuracy;
+    double errorSquared = 0.0;
+    double forceSquared = 0.0;
+    size_t stride = std::max<size_t>(1, bodies.size() / samples);
+
+    auto start = Clock::now();
+    for (size_t i = 0; i < bodies.size(); i += stride) {
+        Vector2D exact = gravity.directForce(bodies, i);
+        Vector2D error = bodies.force[i] - exact;
+        ++accuracy.sampled;
+        errorSquared += error.magnitudeSquared();
+        forceSquared += exact.magnitudeSquared();
+        if (exact.magnitudeSquared() > 0.0f) {
+            accuracy.maxError = std::max(accuracy.maxError,
+                                         static_cast<double>(error.magnitude() / exact.magnitude()));
+        }
+    }
+    accuracy.directMs = elapsedMs(start);
+    accuracy.rmsError = forceSquared > 0.0 ? std::sqrt(errorSquared / forceSquared) : 0.0;
+    return accuracy;
+}
+
+struct TreeTiming {
+    double buildMs = 0.0;
+    double applyMs = 0.0;
+};
+
+// Best of `repeats` runs; leaves the last run's forces in `bodies`
+TreeTiming timeTree(BodyStorage& bodies, BarnesHutGravity& gravity, ThreadPool& pool, int repeats) {
+    TreeTiming best{1e30, 1e30};
+    for (int i = 0; i < repeats; ++i) {
+        auto start = Clock::now();
+        gravity.build(bodies);
+        best.buildMs = std::min(best.buildMs, elapsedMs(start));
+
+        clearForces(bodies);
+        start = Clock::now();
+        gravity.apply(bodies, pool);
+        best.applyMs = std::min(best.applyMs, elapsedMs(start));
+    }
+    return best;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t maxCount = 1000000;
+    float theta = 0.5f;
+    size_t threads = 0;
+    size_t samples = 256;
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (std::strcmp(argv[i], "--max") == 0) {
+            maxCount = std::strtoul(argv[i + 1], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--theta") == 0) {
+            theta = std::strtof(argv[i + 1], nullptr);
+        } else if (std::strcmp(argv[i], "--threads") == 0) {
+            threads = std::strtoul(argv[i + 1], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--samples") == 0) {
+            samples = std::strtoul(argv[i + 1], nullptr, 10);
+        } else {
+            std::fprintf(stderr, "Unknown option %s\n", argv[i]);
+            return 1;
+        }
+    }
+    if (samples == 0) {
+        std::fprintf(stderr, "Need at least one sample\n");
+        return 1;
+    }
+
+    ThreadPool pool(threads);
+    BarnesHutGravity gravity;
+    gravity.theta = theta;
+    BodyStorage bodies;
+
+    std::printf("Barnes-Hut, theta %.2f, softening %.1f, %zu threads\n", gravity.theta, gravity.softening,
+                pool.getThreadCount());
+    std::printf("%10s %8s %10s %10s %10s %12s %10s %10s\n", "bodies", "nodes", "build ms", "walk ms", "ns/body",
+                "direct ms", "rms err", "max err");
+
+    const size_t sizes[] = {1000, 4000, 16000, 64000, 250000, 1000000};
+    for (size_t count : sizes) {
+        if (count > maxCount) break;
+        buildDisc(bodies, count);
+
+        int repeats = count <= 64000 ? 5 : 2;
+        TreeTiming tree = timeTree(bodies, gravity, pool, repeats);
+        Accuracy accuracy = measureAccuracy(bodies, gravity, samples);
+
+        // Full O(n^2) reference where affordable, otherwise extrapolated
+        double directMs;
+        bool estimated = count > kMaxFullDirect;
+        if (estimated) {
+            directMs = accuracy.directMs * count / accuracy.sampled / pool.getThreadCount();
+        } else {
+            clearForces(bodies);
+            auto start = Clock::now();
+            gravity.applyDirect(bodies, pool);
+            directMs = elapsedMs(start);
+        }
+
+        double walkMs = std::max(0.0, tree.applyMs - tree.buildMs);
+        std::printf("%10zu %8zu %10.2f %10.2f %10.1f %11.1f%s %10.2e %10.2e\n", count, gravity.getNodeCount(),
+                    tree.buildMs, walkMs, tree.applyMs * 1e6 / count, directMs, estimated ? "~" : " ",
+                    accuracy.rmsError, accuracy.maxError);
+    }
+
+    // Speed against accuracy for the opening angle, at a mid-sized count
+    size_t sweepCount = std::min<size_t>(maxCount, 64000);
+    buildDisc(bodies, sweepCount);
+    std::printf("\ntheta sweep, %zu bodies\n", sweepCount);
+    std::printf("%10s %10s %10s %10s\n", "theta", "ns/body", "rms err", "max err");
+    const float thetas[] = {0.2f, 0.35f, 0.5f, 0.7f, 1.0f};
+    for (float sweepTheta : thetas) {
+        gravity.theta = sweepTheta;
+        TreeTiming tree = timeTree(bodies, gravity, pool, 3);
+        Accuracy accuracy = measureAccuracy(bodies, gravity, samples);
+        std::printf("%10.2f %10.1f %10.2e %10.2e\n", sweepTheta, tree.applyMs * 1e6 / sweepCount,
+                    accuracy.rmsError, accuracy.maxError);
+    }
+    return 0;
+}
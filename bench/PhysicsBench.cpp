@@ -0,0 +1,262 @@
+// Per-phase engine timings over a few standard scenes.
+// Usage: physica_bench [--bodies N] [--steps N] [--threads N] [--json FILE]
+// Prints a table to stdout; --json also writes the results as JSON so they
+// can be compared across releases ("-" writes JSON to stdout instead).
+#include "PhysicsEngine.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#ifndef PHYSICA_VERSION
+#define PHYSICA_VERSION "unknown"
+#endif
+
+using namespace Physica;
+
+namespace {
+
+constexpr float kTimeStep = 1.0f / 60.0f;
+constexpr int kWarmupSteps = 10;
+
+struct Scene {
+    const char* name;
+    float width;
+    float height;
+};
+
+// Circles of mixed size spread uniformly at constant density, falling
+Scene buildRandomCircles(PhysicsEngine& engine, size_t count) {
+    const float areaPerBody = 40.0f * 40.0f;
+    float side = std::sqrt(areaPerBody * count);
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> coord(0.0f, side);
+    std::uniform_real_distribution<float> speed(-100.0f, 100.0f);
+    std::uniform_real_distribution<float> radius(3.0f, 8.0f);
+    std::uniform_real_distribution<float> mass(1.0f, 20.0f);
+
+    for (size_t i = 0; i < count; ++i) {
+        PhysicsObject obj(Vector2D(coord(rng), coord(rng)), mass(rng));
+        obj.radius = radius(rng);
+        obj.velocity = Vector2D(speed(rng), speed(rng));
+        engine.addObject(obj);
+    }
+    return {"random_circles", side, side};
+}
+
+// Hexagonally packed circles resting on the floor: every body in contact
+Scene buildDensePile(PhysicsEngine& engine, size_t count) {
+    const float radius = 5.0f;
+    const float spacing = 2.0f * radius;
+    size_t columns = std::max<size_t>(1, static_cast<size_t>(std::sqrt(static_cast<double>(count))));
+    size_t rows = (count + columns - 1) / columns;
+    float width = (columns + 1) * spacing;
+    float height = rows * spacing * 0.866f + 4.0f * spacing;
+
+    for (size_t i = 0; i < count; ++i) {
+        size_t row = i / columns;
+        size_t col = i % columns;
+        float x = radius + col * spacing + (row % 2) * radius;
+        float y = height - radius - row * spacing * 0.866f;
+        PhysicsObject obj(Vector2D(x, y), 5.0f);
+        obj.radius = radius;
+        obj.restitution = 0.2f;
+        engine.addObject(obj);
+    }
+    return {"dense_pile", width, height};
+}
+
+// Fast, small, perfectly elastic particles with no gravity or drag
+Scene buildGasBox(PhysicsEngine& engine, size_t count) {
+    const float areaPerBody = 30.0f * 30.0f;
+    float side = std::sqrt(areaPerBody * count);
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<float> coord(0.0f, side);
+    std::uniform_real_distribution<float> speed(-300.0f, 300.0f);
+
+    engine.gravityEnabled = false;
+    engine.airResistanceCoefficient = 0.0f;
+    for (size_t i = 0; i < count; ++i) {
+        PhysicsObject obj(Vector2D(coord(rng), coord(rng)), 1.0f);
+        obj.radius = 2.0f;
+        obj.velocity = Vector2D(speed(rng), speed(rng));
+        obj.restitution = 1.0f;
+        obj.friction = 0.0f;
+        engine.addObject(obj);
+    }
+    return {"gas_box", side, side};
+}
+
+// Random circles stirred by a vortex, with an attractor and a crosswind
+Scene buildForceFields(PhysicsEngine& engine, size_t count) {
+    Scene scene = buildRandomCircles(engine, count);
+    Vector2D center(scene.width * 0.5f, scene.height * 0.5f);
+    float reach = scene.width * 0.5f;
+
+    VortexField vortex;
+    vortex.center = center;
+    vortex.strength = 600.0f;
+    vortex.radius = reach;
+    RadialField attractor;
+    attractor.center = center;
+    attractor.strength = 400.0f;
+    attractor.radius = reach;
+    UniformField wind;
+    wind.acceleration = Vector2D(50.0f, 0.0f);
+
+    engine.addForceField(vortex);
+    engine.addForceField(attractor);
+    engine.addForceField(wind);
+    scene.name = "force_fields";
+    return scene;
+}
+
+using SceneBuilder = Scene (*)(PhysicsEngine&, size_t);
+
+struct PhaseTotals {
+    double integrate = 0.0;
+    double sweep = 0.0;
+    double broadphase = 0.0;
+    double contacts = 0.0;
+    double boundary = 0.0;
+    double total() const { return integrate + sweep + broadphase + contacts + boundary; }
+};
+
+struct SceneResult {
+    std::string name;
+    size_t bodies = 0;
+    int steps = 0;
+    size_t threads = 0;
+    double averageContacts = 0.0;
+    PhaseTotals nsPerBodyStep;
+};
+
+SceneResult runScene(SceneBuilder build, size_t count, int steps, size_t threads) {
+    PhysicsEngine engine;
+    engine.setThreadCount(threads);
+    Scene scene = build(engine, count);
+
+    for (int i = 0; i < kWarmupSteps; ++i) {
+        engine.update(kTimeStep);
+        engine.handleBoundaryCollisions(scene.width, scene.height);
+    }
+
+    using Clock = std::chrono::steady_clock;
+    PhaseTotals totals;
+    double contacts = 0.0;
+    for (int i = 0; i < steps; ++i) {
+        engine.update(kTimeStep);
+        auto start = Clock::now();
+        engine.handleBoundaryCollisions(scene.width, scene.height);
+        totals.boundary += std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+
+        const StepTimings& timings = engine.getLastStepTimings();
+        totals.integrate += timings.integrate;
+        totals.sweep += timings.sweep;
+        totals.broadphase += timings.broadphase;
+        totals.contacts += timings.contacts;
+        contacts += engine.getContactSolver().getContacts().size();
+    }
+
+    double scale = 1.0 / (static_cast<double>(steps) * count);
+    SceneResult result;
+    result.name = scene.name;
+    result.bodies = count;
+    result.steps = steps;
+    result.threads = engine.getThreadCount();
+    result.averageContacts = contacts / steps;
+    result.nsPerBodyStep.integrate = totals.integrate * scale;
+    result.nsPerBodyStep.sweep = totals.sweep * scale;
+    result.nsPerBodyStep.broadphase = totals.broadphase * scale;
+    result.nsPerBodyStep.contacts = totals.contacts * scale;
+    result.nsPerBodyStep.boundary = totals.boundary * scale;
+    return result;
+}
+
+void writeJson(FILE* out, const std::vector<SceneResult>& results, size_t threads) {
+    std::fprintf(out, "{\n");
+    std::fprintf(out, "  \"version\": \"%s\",\n", PHYSICA_VERSION);
+    std::fprintf(out, "  \"simd\": \"%s\",\n", getBestKernels().name);
+    std::fprintf(out, "  \"threads\": %zu,\n", threads);
+    std::fprintf(out, "  \"dt\": %g,\n", kTimeStep);
+    std::fprintf(out, "  \"unit\": \"ns/body/step\",\n");
+    std::fprintf(out, "  \"scenes\": [\n");
+    for (size_t i = 0; i < results.size(); ++i) {
+        const SceneResult& r = results[i];
+        const PhaseTotals& ns = r.nsPerBodyStep;
+        std::fprintf(out, "    {\"name\": \"%s\", \"bodies\": %zu, \"steps\": %d, \"contacts\": %.1f,\n",
+                     r.name.c_str(), r.bodies, r.steps, r.averageContacts);
+        std::fprintf(out, "     \"phases\": {\"integrate\": %.3f, \"sweep\": %.3f, \"broadphase\": %.3f, "
+                     "\"contacts\": %.3f, \"boundary\": %.3f, \"total\": %.3f}}%s\n",
+                     ns.integrate, ns.sweep, ns.broadphase, ns.contacts, ns.boundary, ns.total(),
+                     i + 1 < results.size() ? "," : "");
+    }
+    std::fprintf(out, "  ]\n}\n");
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t count = 10000;
+    int steps = 200;
+    size_t threads = 0;
+    const char* jsonPath = nullptr;
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (std::strcmp(argv[i], "--bodies") == 0) {
+            count = std::strtoul(argv[i + 1], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--steps") == 0) {
+            steps = std::atoi(argv[i + 1]);
+        } else if (std::strcmp(argv[i], "--threads") == 0) {
+            threads = std::strtoul(argv[i + 1], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--json") == 0) {
+            jsonPath = argv[i + 1];
+        } else {
+            std::fprintf(stderr, "Unknown option %s\n", argv[i]);
+            return 1;
+        }
+    }
+    if (count == 0 || steps <= 0) {
+        std::fprintf(stderr, "Need at least one body and one step\n");
+        return 1;
+    }
+
+    const SceneBuilder scenes[] = {buildRandomCircles, buildDensePile, buildGasBox, buildForceFields};
+
+    std::vector<SceneResult> results;
+    for (SceneBuilder build : scenes) {
+        results.push_back(runScene(build, count, steps, threads));
+    }
+
+    size_t threadCount = results.front().threads;
+    bool jsonToStdout = jsonPath && std::strcmp(jsonPath, "-") == 0;
+    if (!jsonToStdout) {
+        std::printf("%zu bodies, %d steps, %zu threads, %s kernels (ns/body/step)\n",
+                    count, steps, threadCount, getBestKernels().name);
+        std::printf("%-16s %10s %10s %10s %10s %10s %10s %10s\n",
+                    "scene", "integrate", "sweep", "broadphase", "contacts", "boundary", "total", "contacts/step");
+        for (const SceneResult& r : results) {
+            const PhaseTotals& ns = r.nsPerBodyStep;
+            std::printf("%-16s %10.2f %10.2f %10.2f %10.2f %10.2f %10.2f %10.0f\n", r.name.c_str(),
+                        ns.integrate, ns.sweep, ns.broadphase, ns.contacts, ns.boundary, ns.total(), r.averageContacts);
+        }
+    }
+
+    if (jsonToStdout) {
+        writeJson(stdout, results, threadCount);
+    } else if (jsonPath) {
+        FILE* out = std::fopen(jsonPath, "w");
+        if (!out) {
+            std::fprintf(stderr, "Cannot write %s\n", jsonPath);
+            return 1;
+        }
+        writeJson(out, results, threadCount);
+        std::fclose(out);
+    }
+    return 0;
+}
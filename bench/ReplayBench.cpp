@@ -0,0 +1,147 @@
+// Replay recording and playback: cost of record() on the stepping thread,
+// file size per body per frame, and a check that every played back frame
+// is within half a quantization step of what was recorded, both playing
+// straight through and after seeking.
+// Usage: physica_replay_bench [--bodies N] [--steps N] [--file PATH]
+#include "PhysicsEngine.h"
+#include "ReplayPlayer.h"
+#include "ReplayRecorder.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace Physica;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Circles dropped into a box: fast motion at first, then a settling pile
+// where bodies fall asleep
+void buildWorld(PhysicsEngine& engine, size_t count) {
+    float side = std::sqrt(2000.0f * count);
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<float> coord(0.0f, side);
+    std::uniform_real_distribution<float> speed(-50.0f, 50.0f);
+
+    engine.setBounds(side, side);
+    engine.getBodies().reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        PhysicsObject obj(Vector2D(coord(rng), coord(rng) * 0.5f), 5.0f);
+        obj.radius = 6.0f;
+        obj.velocity = Vector2D(speed(rng), speed(rng));
+        engine.addObject(obj);
+    }
+}
+
+// Largest coordinate error of a played back frame against the recording
+float frameError(const BodyStorage& played, const AlignedVector<Vector2D>& recorded) {
+    if (played.size() != recorded.size()) return INFINITY;
+    float worst = 0.0f;
+    for (size_t i = 0; i < recorded.size(); ++i) {
+        worst = std::max(worst, std::fabs(played.position[i].x - recorded[i].x));
+        worst = std::max(worst, std::fabs(played.position[i].y - recorded[i].y));
+    }
+    return worst;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t count = 10000;
+    int steps = 600;
+    std::string path = "physica_replay_bench.physrec";
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (std::strcmp(argv[i], "--bodies") == 0) {
+            count = std::strtoul(argv[i + 1], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--steps") == 0) {
+            steps = std::atoi(argv[i + 1]);
+        } else if (std::strcmp(argv[i], "--file") == 0) {
+            path = argv[i + 1];
+        } else {
+            std::fprintf(stderr, "Unknown option %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    const float dt = 1.0f / 60.0f;
+    PhysicsEngine engine;
+    buildWorld(engine, count);
+
+    // Every step's positions, indexed by step, to check playback against
+    std::vector<AlignedVector<Vector2D>> recorded(steps + 1);
+    ReplayRecorder recorder(64);
+    if (!recorder.start(path, dt)) {
+        std::fprintf(stderr, "Cannot write %s\n", path.c_str());
+        return 1;
+    }
+
+    double recordSeconds = 0.0;
+    double stepSeconds = 0.0;
+    const std::uint64_t firstStep = engine.getStepCount();
+    for (int s = 0; s <= steps; ++s) {
+        if (s > 0) {
+            auto start = Clock::now();
+            engine.step(1, dt);
+            stepSeconds += std::chrono::duration<double>(Clock::now() - start).count();
+        }
+        auto start = Clock::now();
+        recorder.record(engine.getBodies(), engine.getStepCount());
+        recordSeconds += std::chrono::duration<double>(Clock::now() - start).count();
+        recorded[s] = engine.getBodies().position;
+    }
+    recorder.stop();
+
+    const double frames = static_cast<double>(recorder.getFramesWritten());
+    const double bytesPerBody = recorder.getBytesWritten() / (frames * count);
+    std::printf("%zu bodies, %d steps: step %.2f ms, record %.1f us per frame, %llu frames dropped\n", count, steps,
+                stepSeconds / steps * 1e3, recordSeconds / (steps + 1) * 1e6,
+                static_cast<unsigned long long>(recorder.getDroppedFrames()));
+    std::printf("%.2f MB, %.2f bytes per body per frame (raw positions: %zu)\n",
+                recorder.getBytesWritten() / (1024.0 * 1024.0), bytesPerBody, sizeof(Vector2D));
+
+    ReplayPlayer player;
+    if (!player.open(path)) {
+        std::fprintf(stderr, "Cannot read %s\n", path.c_str());
+        return 1;
+    }
+    std::remove(path.c_str());
+
+    // Dropped frames are missing from the file, so match frames by step
+    const float tolerance = recorder.precision * 0.5f + 1e-3f;
+    float worst = 0.0f;
+    size_t played = 0;
+    auto start = Clock::now();
+    for (bool more = player.seek(0); more; more = player.next()) {
+        worst = std::max(worst, frameError(player.getBodies(), recorded[player.getStep() - firstStep]));
+        ++played;
+    }
+    double playSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+    std::printf("played %zu frames (%zu keyframes) at %.1f us per frame, largest error %.5f\n", played,
+                player.getKeyframeCount(), playSeconds / played * 1e6, worst);
+
+    // Seeks in both directions must give the same frames as playing through
+    std::mt19937 rng(3);
+    for (int i = 0; i < 50 && worst <= tolerance; ++i) {
+        size_t frame = rng() % player.getFrameCount();
+        if (!player.seek(frame)) {
+            worst = INFINITY;
+            break;
+        }
+        worst = std::max(worst, frameError(player.getBodies(), recorded[player.getStep() - firstStep]));
+    }
+
+    if (played != player.getFrameCount() || worst > tolerance) {
+        std::printf("FAILED: playback differs from the recording by %.5f (tolerance %.5f)\n", worst, tolerance);
+        return 1;
+    }
+    std::printf("playback and seeks within %.5f of the recording\n", tolerance);
+    return 0;
+}
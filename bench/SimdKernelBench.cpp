@@ -0,0 +1,174 @@
+// Checks every variant of every SIMD kernel table against the scalar
+// reference, then times the fused force and integration step for each one.
+// Usage: physica_simd_bench [bodies] [steps]
+#include "SimdKernels.h"
+#include "BodyStorage.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+
+using namespace Physica;
+
+namespace {
+
+// Odd count so every table also runs its masked tail
+BodyStorage buildBodies(size_t count) {
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> position(0.0f, 1000.0f);
+    std::uniform_real_distribution<float> velocity(-200.0f, 200.0f);
+    std::uniform_real_distribution<float> mass(0.5f, 5.0f);
+
+    BodyStorage bodies;
+    bodies.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        PhysicsObject obj(Vector2D(position(rng), position(rng)), mass(rng));
+        obj.velocity = Vector2D(velocity(rng), velocity(rng));
+        // Some resting bodies (skip drag), static ones and frictionless ones
+        if (i % 11 == 0) obj.velocity = Vector2D(0, 0);
+        obj.isStatic = (i % 13 == 0);
+        obj.friction = (i % 3 == 0) ? 0.0f : 0.1f;
+        obj.previousPosition = obj.position - obj.velocity * (1.0f / 60.0f);
+        bodies.add(obj);
+    }
+    return bodies;
+}
+
+BodyBatch makeBatch(BodyStorage& bodies, size_t begin, size_t end) {
+    BodyBatch batch;
+    batch.position = bodies.position.data() + begin;
+    batch.velocity = bodies.velocity.data() + begin;
+    batch.force = bodies.force.data() + begin;
+    batch.previousPosition = bodies.previousPosition.data() + begin;
+    batch.invMass = bodies.invMass.data() + begin;
+    batch.mass = bodies.mass.data() + begin;
+    batch.friction = bodies.friction.data() + begin;
+    batch.count = end - begin;
+    return batch;
+}
+
+// Runs a few steps of one kernel variant in odd-sized chunks
+void runSteps(StepKernel step, BodyStorage& bodies, int steps) {
+    ForceParams params{Vector2D(0.0f, 980.0f), 0.01f};
+    const float dt = 1.0f / 60.0f;
+    const size_t chunk = 1237;
+    for (int i = 0; i < steps; ++i) {
+        for (size_t begin = 0; begin < bodies.size(); begin += chunk) {
+            size_t end = std::min(bodies.size(), begin + chunk);
+            step(makeBatch(bodies, begin, end), params, dt);
+        }
+    }
+}
+
+bool sameBits(const BodyStorage& a, const BodyStorage& b) {
+    size_t bytes = a.size() * sizeof(Vector2D);
+    return std::memcmp(a.position.data(), b.position.data(), bytes) == 0 &&
+           std::memcmp(a.velocity.data(), b.velocity.data(), bytes) == 0 &&
+           std::memcmp(a.force.data(), b.force.data(), bytes) == 0 &&
+           std::memcmp(a.previousPosition.data(), b.previousPosition.data(), bytes) == 0;
+}
+
+// Measure sums are grouped by register width, so they only agree to float
+// rounding of the summed magnitudes (momentum sums largely cancel)
+bool closeMoments(const BodyBatch& batch, const BodyMoments& a, const BodyMoments& b) {
+    BodyMoments scale;
+    for (size_t i = 0; i < batch.count; ++i) {
+        const double m = batch.mass[i];
+        const Vector2D v = batch.velocity[i];
+        const Vector2D p = batch.position[i];
+        scale.kinetic += m * (double(v.x) * v.x + double(v.y) * v.y);
+        scale.momentumX += m * std::abs(v.x);
+        scale.momentumY += m * std::abs(v.y);
+        scale.massX += m * std::abs(p.x);
+        scale.massY += m * std::abs(p.y);
+        scale.mass += m;
+    }
+    auto close = [](double x, double y, double magnitude) { return std::abs(x - y) <= 1e-5 * magnitude + 1e-6; };
+    return close(a.kinetic, b.kinetic, scale.kinetic) && close(a.momentumX, b.momentumX, scale.momentumX) &&
+           close(a.momentumY, b.momentumY, scale.momentumY) && close(a.massX, b.massX, scale.massX) &&
+           close(a.massY, b.massY, scale.massY) && close(a.mass, b.mass, scale.mass);
+}
+
+double nsPerBodyStep(const KernelTable& kernels, BodyStorage& bodies, int steps) {
+    ForceParams params{Vector2D(0.0f, 980.0f), 0.01f};
+    StepKernel step = kernels.select(IntegrationMethod::SemiImplicitEuler, true, true);
+    BodyBatch batch = makeBatch(bodies, 0, bodies.size());
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < steps; ++i) {
+        step(batch, params, 1.0f / 60.0f);
+    }
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    return ns / (double(steps) * bodies.size());
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000003;
+    int steps = argc > 2 ? std::atoi(argv[2]) : 50;
+
+    const BodyStorage initial = buildBodies(count);
+    std::vector<const KernelTable*> tables = getAvailableKernels();
+
+    const IntegrationMethod methods[] = {
+        IntegrationMethod::Euler, IntegrationMethod::SemiImplicitEuler, IntegrationMethod::Verlet};
+    const char* methodNames[] = {"euler", "semi-implicit", "verlet"};
+
+    // Every variant of every table against the same scalar variant
+    bool ok = true;
+    for (size_t m = 0; m < 3; ++m) {
+        for (int flags = 0; flags < 4; ++flags) {
+            bool gravity = flags & 1;
+            bool drag = flags & 2;
+            BodyStorage reference = initial;
+            runSteps(getScalarKernels().select(methods[m], gravity, drag), reference, 4);
+
+            for (const KernelTable* table : tables) {
+                BodyStorage result = initial;
+                runSteps(table->select(methods[m], gravity, drag), result, 4);
+                if (!sameBits(reference, result)) {
+                    std::printf("%s %s (gravity %d, drag %d) differs from scalar\n",
+                                table->name, methodNames[m], gravity, drag);
+                    ok = false;
+                }
+            }
+        }
+    }
+    // Measure kernels over tile-sized batches, tails included
+    BodyStorage measured = initial;
+    for (size_t begin = 0; begin < measured.size(); begin += 253) {
+        BodyBatch batch = makeBatch(measured, begin, std::min(measured.size(), begin + 253));
+        BodyMoments reference;
+        getScalarKernels().measure(batch, reference);
+        for (const KernelTable* table : tables) {
+            BodyMoments moments;
+            table->measure(batch, moments);
+            if (!closeMoments(batch, moments, reference)) {
+                std::printf("%s measure differs from scalar at body %zu\n", table->name, begin);
+                ok = false;
+                break;
+            }
+        }
+    }
+    for (const KernelTable* table : tables) {
+        std::printf("%-8s checked\n", table->name);
+    }
+    if (!ok) {
+        std::printf("FAILED: SIMD kernels diverge from the scalar reference\n");
+        return 1;
+    }
+
+    std::printf("\nfused forces + semi-implicit Euler, %zu bodies, %d steps\n", count, steps);
+    double scalarNs = 0.0;
+    for (const KernelTable* table : tables) {
+        BodyStorage work = initial;
+        double ns = nsPerBodyStep(*table, work, steps);
+        if (table == tables.front()) scalarNs = ns;
+        std::printf("%-8s %7.3f ns/body  %5.2fx\n", table->name, ns, scalarNs / ns);
+    }
+    std::printf("selected: %s\n", getBestKernels().name);
+    return 0;
+}
@@ -0,0 +1,150 @@
+// World snapshot save and load: time to checkpoint and restore a large
+// world, and a check that the restored copy is identical and evolves
+// identically to the original.
+// Usage: physica_snapshot_bench [--bodies N] [--steps N] [--file PATH]
+#include "WorldSnapshot.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+
+using namespace Physica;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double elapsedMs(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// Falling circles with a few boxes, labels and force fields, so every
+// snapshot field has content
+void buildWorld(PhysicsEngine& engine, size_t count) {
+    float side = std::sqrt(1600.0f * count);
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<float> coord(0.0f, side);
+    std::uniform_real_distribution<float> speed(-100.0f, 100.0f);
+    std::uniform_real_distribution<float> mass(1.0f, 20.0f);
+
+    engine.setBounds(side, side);
+    engine.getBodies().reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        PhysicsObject obj(Vector2D(coord(rng), coord(rng)), mass(rng), i % 50 == 0 ? ShapeType::Box : ShapeType::Circle);
+        obj.velocity = Vector2D(speed(rng), speed(rng));
+        obj.width = 12.0f;
+        obj.height = 8.0f;
+        obj.isStatic = i % 997 == 0;
+        obj.isBullet = i % 499 == 0;
+        if (i % 1000 == 0) obj.label = "body " + std::to_string(i);
+        engine.addObject(obj);
+    }
+
+    VortexField vortex;
+    vortex.center = Vector2D(side * 0.5f, side * 0.5f);
+    vortex.strength = 300.0f;
+    vortex.radius = side * 0.25f;
+    engine.addForceField(vortex);
+
+    // Not the defaults, so a load that drops them is caught
+    XpbdSolver& xpbd = engine.getXpbdSolver();
+    xpbd.substeps = 6;
+    xpbd.contactCompliance = 1e-7f;
+    xpbd.wallCompliance = 2e-7f;
+}
+
+template <typename Vector>
+bool sameArray(const Vector& a, const Vector& b) {
+    return a.size() == b.size() && std::memcmp(a.data(), b.data(), a.size() * sizeof(a[0])) == 0;
+}
+
+bool sameBodies(const BodyStorage& a, const BodyStorage& b) {
+    if (!sameArray(a.position, b.position) || !sameArray(a.velocity, b.velocity) || !sameArray(a.force, b.force) ||
+        !sameArray(a.previousPosition, b.previousPosition) || !sameArray(a.invMass, b.invMass) ||
+        !sameArray(a.radius, b.radius) || !sameArray(a.restitution, b.restitution) || !sameArray(a.mass, b.mass) ||
+        !sameArray(a.friction, b.friction) || !sameArray(a.extents, b.extents) || !sameArray(a.shape, b.shape) ||
+        !sameArray(a.motion, b.motion) || !sameArray(a.sleepAnchor, b.sleepAnchor) ||
+        !sameArray(a.sleepTimer, b.sleepTimer) || !sameArray(a.sleepIsland, b.sleepIsland) ||
+        !sameArray(a.bullet, b.bullet)) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); ++i) {
+        const BodyAppearance& x = a.appearance[i];
+        const BodyAppearance& y = b.appearance[i];
+        if (x.colorR != y.colorR || x.colorG != y.colorG || x.colorB != y.colorB || x.label != y.label) return false;
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t count = 1000000;
+    int steps = 20;
+    std::string path = "physica_snapshot_bench.physnap";
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (std::strcmp(argv[i], "--bodies") == 0) {
+            count = std::strtoul(argv[i + 1], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--steps") == 0) {
+            steps = std::atoi(argv[i + 1]);
+        } else if (std::strcmp(argv[i], "--file") == 0) {
+            path = argv[i + 1];
+        } else {
+            std::fprintf(stderr, "Unknown option %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    PhysicsEngine original;
+    buildWorld(original, count);
+    original.step(steps, 1.0f / 60.0f);
+
+    auto start = Clock::now();
+    if (!saveWorldSnapshot(original, path)) {
+        std::fprintf(stderr, "Cannot write %s\n", path.c_str());
+        return 1;
+    }
+    double saveMs = elapsedMs(start);
+
+    PhysicsEngine restored;
+    start = Clock::now();
+    if (!loadWorldSnapshot(restored, path)) {
+        std::fprintf(stderr, "Cannot read %s\n", path.c_str());
+        return 1;
+    }
+    double loadMs = elapsedMs(start);
+
+    FILE* file = std::fopen(path.c_str(), "rb");
+    std::fseek(file, 0, SEEK_END);
+    double megabytes = std::ftell(file) / (1024.0 * 1024.0);
+    std::fclose(file);
+    std::remove(path.c_str());
+
+    std::printf("%zu bodies, %.1f MB: save %.1f ms (%.0f MB/s), load %.1f ms (%.0f MB/s)\n", count, megabytes,
+                saveMs, megabytes / saveMs * 1000.0, loadMs, megabytes / loadMs * 1000.0);
+
+    bool ok = sameBodies(original.getBodies(), restored.getBodies()) &&
+              original.getStepCount() == restored.getStepCount() &&
+              original.getSleepingCount() == restored.getSleepingCount() &&
+              original.getXpbdSolver().substeps == restored.getXpbdSolver().substeps &&
+              original.getXpbdSolver().contactCompliance == restored.getXpbdSolver().contactCompliance &&
+              original.getXpbdSolver().wallCompliance == restored.getXpbdSolver().wallCompliance;
+    if (!ok) {
+        std::printf("FAILED: restored world differs from the original\n");
+        return 1;
+    }
+
+    // A fork must evolve exactly like the original
+    original.step(steps, 1.0f / 60.0f);
+    restored.step(steps, 1.0f / 60.0f);
+    if (!sameBodies(original.getBodies(), restored.getBodies())) {
+        std::printf("FAILED: restored world diverges after %d steps\n", steps);
+        return 1;
+    }
+    std::printf("restored world identical, and still identical after %d more steps\n", steps);
+    return 0;
+}
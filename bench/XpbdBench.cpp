@@ -0,0 +1,181 @@
+// Stacking: a wide hex-packed pile resting on the floor, stepped with the
+// default solver at shrinking time steps and with XPBD substeps at a full
+// frame step. Reports how far the pile sinks, how deep bodies overlap and
+// how much they jitter, and the cost of each, then the cheapest stable
+// setting of each solver. Fails if no XPBD setting is stable.
+// Usage: physica_xpbd_bench [--bodies N] [--seconds S]
+#include "Collision.h"
+#include "PhysicsEngine.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+using namespace Physica;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr float kRadius = 4.0f;
+constexpr size_t kColumns = 400;
+
+// Stable: the pile sinks less than a quarter radius, bodies overlap by
+// less than a tenth of one, and it comes to rest
+constexpr float kMaxPenetration = 0.1f * kRadius;
+constexpr float kMaxSink = 0.25f * kRadius;
+constexpr float kMaxMeanSpeed = 5.0f;  // pixels/s
+
+struct Config {
+    const char* label;
+    IntegrationMethod method;
+    int stepsPerFrame;  // Default solver: steps of 1/60 s divided this many times
+    int substeps;       // XPBD: substeps of one 1/60 s step
+};
+
+struct Result {
+    float sink;           // Drop of the center of mass, pixels
+    float penetration;    // Deepest overlap at the end, pixels
+    float meanSpeed;      // pixels/s at the end
+    double msPerSecond;   // Wall time per simulated second
+    bool stable() const {
+        return sink < kMaxSink && penetration < kMaxPenetration && meanSpeed < kMaxMeanSpeed;
+    }
+};
+
+void buildPile(PhysicsEngine& engine, size_t count) {
+    const float spacing = 2.0f * kRadius;
+    const size_t rows = (count + kColumns - 1) / kColumns;
+    const float rowHeight = spacing * std::sqrt(3.0f) * 0.5f;
+    const float width = kColumns * spacing + kRadius;
+    const float height = rows * rowHeight + 4.0f * spacing;
+    engine.setBounds(width, height);
+    engine.sleepingEnabled = false;  // Measure the solver, not sleeping
+    engine.airResistanceCoefficient = 0.0f;
+
+    // Rows a hair apart so the pile starts at rest, just touching
+    for (size_t i = 0; i < count; ++i) {
+        size_t row = i / kColumns;
+        size_t col = i % kColumns;
+        float x = kRadius + col * spacing + (row % 2) * kRadius;
+        float y = height - kRadius - row * (rowHeight + 0.001f);
+        PhysicsObject obj(Vector2D(x, y), 5.0f);
+        obj.radius = kRadius;
+        obj.restitution = 0.2f;
+        obj.friction = 0.0f;
+        engine.addObject(obj);
+    }
+}
+
+float centerOfMassY(const BodyStorage& bodies) {
+    double sum = 0.0;
+    for (size_t i = 0; i < bodies.size(); ++i) {
+        sum += bodies.position[i].y;
+    }
+    return static_cast<float>(sum / bodies.size());
+}
+
+float deepestOverlap(const BodyStorage& bodies) {
+    UniformGridBroadphase grid;
+    std::vector<BodyPair> pairs;
+    grid.findPairs(bodies, pairs);
+    float deepest = 0.0f;
+    for (const BodyPair& pair : pairs) {
+        Vector2D normal;
+        float penetration;
+        if (computeContact(bodies, pair.a, pair.b, normal, penetration)) {
+            deepest = std::max(deepest, penetration);
+        }
+    }
+    return deepest;
+}
+
+Result run(const Config& config, size_t count, float seconds) {
+    PhysicsEngine engine;
+    buildPile(engine, count);
+    engine.setIntegrationMethod(config.method);
+    engine.getXpbdSolver().substeps = config.substeps;
+    const float startY = centerOfMassY(engine.getBodies());
+
+    const float dt = 1.0f / (60.0f * config.stepsPerFrame);
+    const size_t steps = static_cast<size_t>(std::lround(seconds / dt));
+    auto start = Clock::now();
+    engine.step(steps, dt);
+    double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+
+    const BodyStorage& bodies = engine.getBodies();
+    double speed = 0.0;
+    for (size_t i = 0; i < bodies.size(); ++i) {
+        speed += bodies.velocity[i].magnitude();
+    }
+    Result result;
+    result.sink = centerOfMassY(bodies) - startY;
+    result.penetration = deepestOverlap(bodies);
+    result.meanSpeed = static_cast<float>(speed / bodies.size());
+    result.msPerSecond = elapsed * 1e3 / seconds;
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t bodies = 10000;
+    float seconds = 2.0f;
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (std::strcmp(argv[i], "--bodies") == 0) {
+            bodies = std::strtoul(argv[i + 1], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--seconds") == 0) {
+            seconds = std::strtof(argv[i + 1], nullptr);
+        } else {
+            std::fprintf(stderr, "Unknown option %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    const Config configs[] = {
+        {"default, dt 1/60", IntegrationMethod::SemiImplicitEuler, 1, 1},
+        {"default, dt 1/120", IntegrationMethod::SemiImplicitEuler, 2, 1},
+        {"default, dt 1/240", IntegrationMethod::SemiImplicitEuler, 4, 1},
+        {"default, dt 1/480", IntegrationMethod::SemiImplicitEuler, 8, 1},
+        {"xpbd, 4 substeps", IntegrationMethod::Xpbd, 1, 4},
+        {"xpbd, 8 substeps", IntegrationMethod::Xpbd, 1, 8},
+        {"xpbd, 16 substeps", IntegrationMethod::Xpbd, 1, 16},
+    };
+
+    std::printf("%zu bodies of radius %.0f px in a pile, %.1f simulated seconds\n", bodies, kRadius, seconds);
+    std::printf("%-20s %10s %12s %12s %14s %8s\n", "solver", "sink px", "overlap px", "speed px/s",
+                "ms per sim s", "stable");
+    const Config* cheapest[2] = {nullptr, nullptr};  // Default, XPBD
+    double cheapestMs[2] = {0.0, 0.0};
+    double finestDefaultMs = 0.0;
+    for (const Config& config : configs) {
+        Result r = run(config, bodies, seconds);
+        if (config.method != IntegrationMethod::Xpbd) {
+            finestDefaultMs = r.msPerSecond;
+        }
+        std::printf("%-20s %10.3f %12.3f %12.2f %14.1f %8s\n", config.label, r.sink, r.penetration, r.meanSpeed,
+                    r.msPerSecond, r.stable() ? "yes" : "no");
+        int solver = config.method == IntegrationMethod::Xpbd ? 1 : 0;
+        if (r.stable() && (!cheapest[solver] || r.msPerSecond < cheapestMs[solver])) {
+            cheapest[solver] = &config;
+            cheapestMs[solver] = r.msPerSecond;
+        }
+    }
+
+    std::printf("cheapest stable default: %s\n", cheapest[0] ? cheapest[0]->label : "none");
+    std::printf("cheapest stable xpbd:    %s\n", cheapest[1] ? cheapest[1]->label : "none");
+    if (cheapest[0] && cheapest[1]) {
+        std::printf("xpbd cost relative to default: %.2fx\n", cheapestMs[1] / cheapestMs[0]);
+    } else if (cheapest[1]) {
+        std::printf("xpbd cost relative to the finest default step: %.2fx\n", cheapestMs[1] / finestDefaultMs);
+    }
+    if (!cheapest[1]) {
+        std::printf("FAILED\n");
+        return 1;
+    }
+    return 0;
+}
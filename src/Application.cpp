@@ -1,5 +1,9 @@
 #include "Application.h"
+#include "Scenes.h"
+#include "WorldSnapshot.h"
 #include <SFML/Window.hpp>
+#include <algorithm>
+#include <chrono>
 #include <cmath>
 #include <iostream>
 #include <optional>
@@ -7,16 +11,30 @@
 
 namespace Physica {
 
+namespace {
+
+// F5 saves the world here and F9 restores it
+const char* const kCheckpointPath = "checkpoint.physnap";
+
+// F6 records here and F7 plays it back
+const char* const kReplayPath = "replay.physrec";
+
+} // namespace
+
 Application::Application()
     : window(sf::VideoMode({1280, 720}), "Vectorverse - Educational Physics Sandbox"),
-      isPaused(false), isStepping(false), simulationSpeed(1.0f),
-      timeAccumulator(0.0f), fixedTimeStep(1.0f / 60.0f), elapsedTime(0.0f),
-      isDragging(false), maxEnergyHistory(300), showUI(true),
+      isPaused(false), simulationSpeed(1.0f), isDragging(false), energyHistory(4096, 300), energyGraph(300), showUI(true),
       showEnergyGraph(true), currentModule(SimulationModule::Sandbox) {
     
-    window.setFramerateLimit(60);
+    // Frames follow the display; physics keeps its own fixed step
+    window.setVerticalSyncEnabled(true);
+    worldView = window.getDefaultView();
     
-    physicsEngine = std::make_unique<PhysicsEngine>();
+    auto engine = std::make_unique<PhysicsEngine>();
+    engine->setBounds(1280, 720);
+    physics = std::make_unique<PhysicsThread>(std::move(engine), 1.0f / 60.0f);
+    physics->setSpeed(simulationSpeed);
+    snapshot = &physics->acquireSnapshot();
     renderer = std::make_unique<Renderer>(window);
     
     loadSandbox();
@@ -25,19 +43,9 @@ Application::Application()
 Application::~Application() = default;
 
 void Application::run() {
-    sf::Clock clock;
-    
     while (window.isOpen()) {
-        float dt = clock.restart().asSeconds();
-        dt = std::min(dt, 0.1f); // Cap dt to prevent spiral of death
-        
         processEvents();
-        
-        if (!isPaused || isStepping) {
-            update(dt * simulationSpeed);
-            isStepping = false;
-        }
-        
+        update();
         render();
     }
 }
@@ -48,84 +56,140 @@ void Application::processEvents() {
             window.close();
         }
         else if (const auto* mousePress = event->getIf<sf::Event::MouseButtonPressed>()) {
-            if (mousePress->button == sf::Mouse::Button::Left) {
+            if (replay && mousePress->button != sf::Mouse::Button::Middle) {
+                // A replay cannot be edited
+            }
+            else if (mousePress->button == sf::Mouse::Button::Left) {
                 // Left click only creates objects
-                Vector2D pos(sf::Mouse::getPosition(window).x, sf::Mouse::getPosition(window).y);
-                createObject(pos, 10.0f);
+                createObject(toWorld(sf::Mouse::getPosition(window)), 10.0f);
             }
             else if (mousePress->button == sf::Mouse::Button::Right) {
                 // Right click for slingshot mechanic
                 handleMousePress(sf::Mouse::getPosition(window));
             }
+            else if (mousePress->button == sf::Mouse::Button::Middle) {
+                isPanning = true;
+                panLastPixel = mousePress->position;
+            }
         }
         else if (const auto* mouseRelease = event->getIf<sf::Event::MouseButtonReleased>()) {
             if (mouseRelease->button == sf::Mouse::Button::Right) {
                 handleMouseRelease();
             }
+            else if (mouseRelease->button == sf::Mouse::Button::Middle) {
+                isPanning = false;
+            }
         }
-        else if (event->is<sf::Event::MouseMoved>()) {
+        else if (const auto* mouseMove = event->getIf<sf::Event::MouseMoved>()) {
+            if (isPanning) {
+                Vector2D delta = toWorld(panLastPixel) - toWorld(mouseMove->position);
+                worldView.move(sf::Vector2f(delta.x, delta.y));
+                panLastPixel = mouseMove->position;
+            }
             handleMouseMove(sf::Mouse::getPosition(window));
         }
+        else if (const auto* wheel = event->getIf<sf::Event::MouseWheelScrolled>()) {
+            zoomView(wheel->delta > 0 ? 0.9f : 1.0f / 0.9f, wheel->position);
+        }
         else if (const auto* keyPress = event->getIf<sf::Event::KeyPressed>()) {
             handleKeyPress(keyPress->code);
         }
     }
 }
 
-void Application::update(float dt) {
-    timeAccumulator += dt;
+void Application::update() {
+    auto now = std::chrono::steady_clock::now();
+    float frameTime = std::chrono::duration<float>(now - lastFrame).count();
+    lastFrame = now;
     
-    while (timeAccumulator >= fixedTimeStep) {
-        physicsEngine->update(fixedTimeStep);
-        physicsEngine->handleBoundaryCollisions(1280, 720);
-        
-        elapsedTime += fixedTimeStep;
-        updateEnergyTracking();
-        
-        timeAccumulator -= fixedTimeStep;
+    snapshot = &physics->acquireSnapshot();
+    if (replay) {
+        // Hold the last frame once the replay ends
+        replayClock = std::min(replayClock + frameTime * simulationSpeed, PhysicsThread::kMaxCatchUp);
+        while (replayClock >= replay->getTimeStep() && replay->next()) {
+            replayClock -= replay->getTimeStep();
+        }
+        drawPositions = replay->getBodies().position;
+    } else {
+        snapshot->interpolate(snapshot->alphaAt(now), drawPositions);
     }
+    if (trajectoryDirty && isDragging && selectedObject) {
+        physics->predictTrajectory(*selectedObject, dragStartPos, launchVelocity);
+        trajectoryDirty = false;
+    }
+    updateEnergyTracking();
 }
 
 void Application::render() {
     window.clear(sf::Color(20, 20, 30));
     
-    renderer->render(physicsEngine->getObjects());
+    // Simulation in the world view, overlays in window pixels
+    window.setView(worldView);
+    renderer->render(replay ? replay->getBodies() : snapshot->bodies, drawPositions);
+    if (isDragging) {
+        renderTrajectory();
+    }
+    window.setView(window.getDefaultView());
     
     if (showEnergyGraph) {
         renderEnergyGraph();
     }
     
-    if (isDragging) {
-        renderTrajectory();
-    }
-    
     window.display();
 }
 
+Vector2D Application::toWorld(const sf::Vector2i& pixel) const {
+    sf::Vector2f world = window.mapPixelToCoords(pixel, worldView);
+    return Vector2D(world.x, world.y);
+}
+
+void Application::zoomView(float factor, const sf::Vector2i& pixel) {
+    // Keep the point under the cursor fixed
+    Vector2D before = toWorld(pixel);
+    worldView.zoom(factor);
+    Vector2D after = toWorld(pixel);
+    worldView.move(sf::Vector2f(before.x - after.x, before.y - after.y));
+}
+
 void Application::handleMousePress(const sf::Vector2i& mousePos) {
-    Vector2D pos(mousePos.x, mousePos.y);
-    selectedObject = getObjectAtPosition(pos);
+    Vector2D pos = toWorld(mousePos);
+    std::optional<size_t> hit = getObjectAtPosition(pos);
+    selectedObject.reset();
     
-    if (selectedObject && !selectedObject->isStatic) {
+    const BodyStorage& bodies = snapshot->bodies;
+    if (hit) {
+        selectedObject = bodies.handle(*hit);
+    }
+    if (hit && bodies.motion[*hit] != BodyMotion::Static) {
+        BodyHandle handle = *selectedObject;
+        physics->post([handle](PhysicsEngine& engine) {
+            if (std::optional<size_t> index = engine.findObject(handle)) engine.wakeObject(*index);
+        });
         isDragging = true;
-        dragStartPos = selectedObject->position; // Store object's original position
-        predictedTrajectory.clear();
+        dragStartPos = bodies.position[*hit]; // Store object's original position
+        launchVelocity = Vector2D(0, 0);
+        trajectoryDirty = true;
     }
 }
 
 void Application::handleMouseRelease() {
     if (isDragging && selectedObject) {
-        // Launch object with calculated velocity (already set in handleMouseMove)
-        // No need to modify velocity here - it's already correct
+        // Launch object with calculated velocity (already set in handleMouseMove).
+        // It may have dozed off while held still.
+        BodyHandle handle = *selectedObject;
+        physics->post([handle](PhysicsEngine& engine) {
+            if (std::optional<size_t> index = engine.findObject(handle)) engine.wakeObject(*index);
+        });
     }
     isDragging = false;
-    selectedObject = nullptr;
-    predictedTrajectory.clear();
+    selectedObject.reset();
+    trajectoryDirty = false;
+    physics->clearTrajectory();
 }
 
 void Application::handleMouseMove(const sf::Vector2i& mousePos) {
-    if (isDragging && selectedObject) {
-        Vector2D currentMousePos(mousePos.x, mousePos.y);
+    if (isDragging && selectedObject && snapshot->bodies.find(*selectedObject)) {
+        Vector2D currentMousePos = toWorld(mousePos);
         
         // Angry Birds style: pull back from object position
         // The vector FROM mouse TO object is the pull direction
@@ -133,36 +197,91 @@ void Application::handleMouseMove(const sf::Vector2i& mousePos) {
         
         // Velocity is proportional to pull distance (scaled for gameplay)
         // The further you pull, the faster it goes
-        selectedObject->velocity = pullVector * 3.0f;
+        Vector2D velocity = pullVector * 3.0f;
         
-        // Object stays at original position until release
-        selectedObject->position = dragStartPos;
+        // Object stays at original position until release, with its
+        // previous position a step behind as a Verlet step leaves it
+        BodyHandle handle = *selectedObject;
+        Vector2D position = dragStartPos;
+        float dt = physics->getFixedTimeStep();
+        physics->post([handle, position, velocity, dt](PhysicsEngine& engine) {
+            std::optional<size_t> index = engine.findObject(handle);
+            if (!index) return;
+            BodyRef body = engine.getObject(*index);
+            body.velocity() = velocity;
+            body.position() = position;
+            body.previousPosition() = position - velocity * dt;
+        });
         
-        // Calculate predicted trajectory in LAUNCH direction (opposite of pull)
-        calculateTrajectory(dragStartPos, selectedObject->velocity, selectedObject->mass);
+        // Predicted once per frame in update(), however often the mouse moves
+        launchVelocity = velocity;
+        trajectoryDirty = true;
     }
 }
 
 void Application::handleKeyPress(sf::Keyboard::Key key) {
     if (key == sf::Keyboard::Key::Space) {
         isPaused = !isPaused;
+        // Physics stays paused under a replay
+        if (!replay) {
+            physics->setPaused(isPaused);
+        }
     }
     else if (key == sf::Keyboard::Key::S) {
-        isStepping = true;
+        physics->stepOnce();
     }
     else if (key == sf::Keyboard::Key::R) {
         loadModule(currentModule);
     }
     else if (key == sf::Keyboard::Key::C) {
-        physicsEngine->clearObjects();
-        energyHistory.clear();
+        selectedObject.reset();
+        isDragging = false;
+        physics->post([](PhysicsEngine& engine) {
+            engine.clearObjects();
+            engine.clearForceFields();
+        });
+        physics->restartClock();
     }
     else if (key == sf::Keyboard::Key::G) {
-        physicsEngine->gravityEnabled = !physicsEngine->gravityEnabled;
+        physics->post([](PhysicsEngine& engine) { engine.gravityEnabled = !engine.gravityEnabled; });
+    }
+    else if (key == sf::Keyboard::Key::N) {
+        physics->post([](PhysicsEngine& engine) {
+            bool mutual = engine.getGravityMode() == GravityMode::Mutual;
+            engine.setGravityMode(mutual ? GravityMode::Uniform : GravityMode::Mutual);
+        });
+    }
+    else if (key == sf::Keyboard::Key::Hyphen) {
+        energyGraph.setLevel(energyGraph.getLevel() + 1);
+    }
+    else if (key == sf::Keyboard::Key::Equal) {
+        if (energyGraph.getLevel() > 0) energyGraph.setLevel(energyGraph.getLevel() - 1);
+    }
+    else if (key == sf::Keyboard::Key::D) {
+        renderer->showGrid = !renderer->showGrid;
+    }
+    else if (key == sf::Keyboard::Key::Num0) {
+        worldView = window.getDefaultView();
     }
     else if (key == sf::Keyboard::Key::V) {
         renderer->showVelocityVectors = !renderer->showVelocityVectors;
     }
+    else if (key == sf::Keyboard::Key::B) {
+        // Cycle broadphase: grid -> sweep and prune -> brute force
+        physics->post([](PhysicsEngine& engine) {
+            switch (engine.getBroadphaseMethod()) {
+                case BroadphaseMethod::UniformGrid:
+                    engine.setBroadphaseMethod(BroadphaseMethod::SweepAndPrune);
+                    break;
+                case BroadphaseMethod::SweepAndPrune:
+                    engine.setBroadphaseMethod(BroadphaseMethod::BruteForce);
+                    break;
+                case BroadphaseMethod::BruteForce:
+                    engine.setBroadphaseMethod(BroadphaseMethod::UniformGrid);
+                    break;
+            }
+        });
+    }
     else if (key == sf::Keyboard::Key::Num1) {
         loadModule(SimulationModule::Sandbox);
     }
@@ -172,93 +291,124 @@ void Application::handleKeyPress(sf::Keyboard::Key key) {
     else if (key == sf::Keyboard::Key::Num3) {
         loadModule(SimulationModule::ElasticCollisions);
     }
+    else if ((key == sf::Keyboard::Key::Delete || key == sf::Keyboard::Key::Backspace) && !replay) {
+        // Remove the body under the cursor; the handle makes a repeat a no-op
+        std::optional<size_t> hit = getObjectAtPosition(toWorld(sf::Mouse::getPosition(window)));
+        if (hit) {
+            BodyHandle handle = snapshot->bodies.handle(*hit);
+            if (selectedObject == handle) {
+                selectedObject.reset();
+                isDragging = false;
+                physics->clearTrajectory();
+            }
+            physics->post([handle](PhysicsEngine& engine) { engine.removeObject(handle); });
+        }
+    }
+    else if (key == sf::Keyboard::Key::F5) {
+        physics->post([](PhysicsEngine& engine) {
+            if (!saveWorldSnapshot(engine, kCheckpointPath)) {
+                std::cerr << "Could not save " << kCheckpointPath << std::endl;
+            }
+        });
+    }
+    else if (key == sf::Keyboard::Key::F9) {
+        selectedObject.reset();
+        isDragging = false;
+        physics->post([](PhysicsEngine& engine) {
+            if (!loadWorldSnapshot(engine, kCheckpointPath)) {
+                std::cerr << "Could not load " << kCheckpointPath << std::endl;
+            }
+        });
+        physics->restartClock();
+    }
+    else if (key == sf::Keyboard::Key::F6 && !replay) {
+        if (snapshot->recording) {
+            physics->stopRecording();
+        } else {
+            physics->startRecording(kReplayPath);
+        }
+    }
+    else if (key == sf::Keyboard::Key::F7 && !snapshot->recording) {
+        toggleReplay();
+    }
+    else if (key == sf::Keyboard::Key::Left && replay) {
+        size_t keyframe = replay->getKeyframe();
+        replay->seekKeyframe(keyframe > 0 ? keyframe - 1 : 0);
+    }
+    else if (key == sf::Keyboard::Key::Right && replay) {
+        replay->seekKeyframe(replay->getKeyframe() + 1);
+    }
+}
+
+void Application::toggleReplay() {
+    if (replay) {
+        replay.reset();
+        physics->setPaused(isPaused);
+        return;
+    }
+    
+    auto player = std::make_unique<ReplayPlayer>();
+    if (!player->open(kReplayPath)) {
+        std::cerr << "Could not open " << kReplayPath << std::endl;
+        return;
+    }
+    selectedObject.reset();
+    isDragging = false;
+    replay = std::move(player);
+    replayClock = 0.0f;
+    physics->setPaused(true);
 }
 
-std::shared_ptr<PhysicsObject> Application::getObjectAtPosition(const Vector2D& pos) {
-    for (auto& obj : physicsEngine->getObjects()) {
-        float dist = Vector2D::distance(pos, obj->position);
-        if (obj->shape == ShapeType::Circle && dist < obj->radius) {
-            return obj;
+std::optional<size_t> Application::getObjectAtPosition(const Vector2D& pos) const {
+    // Hit test against what is on screen
+    const BodyStorage& bodies = snapshot->bodies;
+    for (size_t i = 0; i < bodies.size() && i < drawPositions.size(); ++i) {
+        float dist = Vector2D::distance(pos, drawPositions[i]);
+        if (bodies.shape[i] == ShapeType::Circle && dist < bodies.radius[i]) {
+            return i;
         }
     }
-    return nullptr;
+    return std::nullopt;
 }
 
 void Application::createObject(const Vector2D& position, float mass, const Vector2D& velocity) {
-    auto obj = std::make_shared<PhysicsObject>(position, mass);
-    obj->velocity = velocity;
-    obj->colorR = 0.3f + (rand() % 100) / 300.0f;
-    obj->colorG = 0.3f + (rand() % 100) / 300.0f;
-    obj->colorB = 0.6f + (rand() % 100) / 300.0f;
-    physicsEngine->addObject(obj);
+    PhysicsObject obj(position, mass);
+    obj.velocity = velocity;
+    obj.colorR = 0.3f + (rand() % 100) / 300.0f;
+    obj.colorG = 0.3f + (rand() % 100) / 300.0f;
+    obj.colorB = 0.6f + (rand() % 100) / 300.0f;
+    addObject(obj);
+}
+
+void Application::addObject(const PhysicsObject& object) {
+    physics->post([object](PhysicsEngine& engine) { engine.addObject(object); });
 }
 
 void Application::updateEnergyTracking() {
-    EnergyData data;
-    data.time = elapsedTime;
-    data.kinetic = physicsEngine->getTotalKineticEnergy();
-    data.potential = physicsEngine->getTotalPotentialEnergy();
-    data.total = data.kinetic + data.potential;
-    
-    energyHistory.push_back(data);
-    if (energyHistory.size() > maxEnergyHistory) {
-        energyHistory.pop_front();
+    physics->takeEnergySamples(energySamples);
+    for (const EnergySample& sample : energySamples) {
+        if (sample.restart) {
+            energyHistory.clear();
+        } else {
+            energyHistory.push(sample.data);
+        }
     }
+    energySamples.clear();
 }
 
 void Application::renderEnergyGraph() {
-    if (energyHistory.empty()) return;
-    
-    float graphX = 900.0f;
-    float graphY = 20.0f;
-    float graphW = 350.0f;
-    float graphH = 150.0f;
-    
-    // Background
-    sf::RectangleShape bg(sf::Vector2f(graphW, graphH));
-    bg.setPosition({graphX, graphY});
-    bg.setFillColor(sf::Color(0, 0, 0, 150));
-    window.draw(bg);
-    
-    // Find max energy for scaling
-    float maxE = 1.0f;
-    for (const auto& d : energyHistory) {
-        maxE = std::max(maxE, d.total);
-    }
-    
-    // Draw energy lines
-    if (energyHistory.size() > 1) {
-        float xStep = graphW / maxEnergyHistory;
-        
-        // Total energy (white)
-        sf::VertexArray totalLine(sf::PrimitiveType::LineStrip);
-        // Kinetic energy (green)
-        sf::VertexArray kineticLine(sf::PrimitiveType::LineStrip);
-        // Potential energy (red)
-        sf::VertexArray potentialLine(sf::PrimitiveType::LineStrip);
-        
-        for (size_t i = 0; i < energyHistory.size(); ++i) {
-            float x = graphX + i * xStep;
-            float yTotal = graphY + graphH - (energyHistory[i].total / maxE) * graphH;
-            float yKinetic = graphY + graphH - (energyHistory[i].kinetic / maxE) * graphH;
-            float yPotential = graphY + graphH - (energyHistory[i].potential / maxE) * graphH;
-            
-            totalLine.append(sf::Vertex{{x, yTotal}, sf::Color::White});
-            kineticLine.append(sf::Vertex{{x, yKinetic}, sf::Color::Green});
-            potentialLine.append(sf::Vertex{{x, yPotential}, sf::Color::Red});
-        }
-        
-        window.draw(kineticLine);
-        window.draw(potentialLine);
-        window.draw(totalLine);
-    }
+    energyGraph.draw(window, energyHistory, sf::FloatRect({900.0f, 20.0f}, {350.0f, 150.0f}));
 }
 
 void Application::loadModule(SimulationModule module) {
     currentModule = module;
-    physicsEngine->clearObjects();
-    energyHistory.clear();
-    elapsedTime = 0.0f;
+    selectedObject.reset();
+    isDragging = false;
+    physics->post([](PhysicsEngine& engine) {
+        engine.clearObjects();
+        engine.clearForceFields();
+    });
+    physics->restartClock();
     
     switch (module) {
         case SimulationModule::Sandbox:
@@ -287,37 +437,15 @@ void Application::loadSandbox() {
 }
 
 void Application::loadProjectileMotion() {
-    auto obj = std::make_shared<PhysicsObject>(Vector2D(100, 600), 10.0f);
-    obj->velocity = Vector2D(300, -400);
-    obj->colorR = 1.0f;
-    obj->colorG = 0.5f;
-    obj->colorB = 0.0f;
-    physicsEngine->addObject(obj);
+    physics->post([](PhysicsEngine& engine) { addProjectileMotionScene(engine); });
 }
 
 void Application::loadElasticCollisions() {
-    auto obj1 = std::make_shared<PhysicsObject>(Vector2D(300, 360), 15.0f);
-    obj1->velocity = Vector2D(200, 0);
-    obj1->restitution = 1.0f;
-    obj1->colorR = 0.2f;
-    obj1->colorG = 0.8f;
-    obj1->colorB = 1.0f;
-    physicsEngine->addObject(obj1);
-    
-    auto obj2 = std::make_shared<PhysicsObject>(Vector2D(800, 360), 15.0f);
-    obj2->velocity = Vector2D(-200, 0);
-    obj2->restitution = 1.0f;
-    obj2->colorR = 1.0f;
-    obj2->colorG = 0.3f;
-    obj2->colorB = 0.3f;
-    physicsEngine->addObject(obj2);
+    physics->post([](PhysicsEngine& engine) { addElasticCollisionsScene(engine); });
 }
 
 void Application::loadHarmonicMotion() {
-    // Simple pendulum-like motion
-    auto obj = std::make_shared<PhysicsObject>(Vector2D(640, 200), 10.0f);
-    obj->velocity = Vector2D(200, 0);
-    physicsEngine->addObject(obj);
+    physics->post([](PhysicsEngine& engine) { addHarmonicMotionScene(engine); });
 }
 
 void Application::loadInclinedPlane() {
@@ -325,48 +453,20 @@ void Application::loadInclinedPlane() {
     createObject(Vector2D(300, 400), 10.0f, Vector2D(100, -50));
 }
 
-void Application::calculateTrajectory(const Vector2D& startPos, const Vector2D& velocity, float mass) {
-    predictedTrajectory.clear();
-    
-    // Simulate the trajectory for a short time
-    const int numPoints = 50;
-    const float dt = 0.05f; // 50ms timesteps
-    
-    Vector2D pos = startPos;
-    Vector2D vel = velocity;
-    
-    // Get gravity from physics engine
-    Vector2D gravity = physicsEngine->getGravity();
-    
-    for (int i = 0; i < numPoints; ++i) {
-        predictedTrajectory.push_back(pos);
-        
-        // Simple Euler integration for prediction
-        Vector2D acceleration = gravity;
-        vel += acceleration * dt;
-        pos += vel * dt;
-        
-        // Stop if trajectory goes off screen or hits ground
-        if (pos.x < 0 || pos.x > 1280 || pos.y > 720) {
-            break;
-        }
-    }
-}
-
 void Application::renderTrajectory() {
     // Draw slingshot lines (like rubber bands)
     if (isDragging && selectedObject) {
-        sf::Vector2i mousePos = sf::Mouse::getPosition(window);
+        Vector2D mousePos = toWorld(sf::Mouse::getPosition(window));
         Vector2D objectPos = dragStartPos;
         
         // Draw two lines from object to mouse (like slingshot bands)
         sf::Vertex leftBand[] = {
             sf::Vertex{{objectPos.x - 10, objectPos.y}, sf::Color(139, 69, 19, 200)}, // Brown
-            sf::Vertex{{static_cast<float>(mousePos.x), static_cast<float>(mousePos.y)}, sf::Color(139, 69, 19, 200)}
+            sf::Vertex{{mousePos.x, mousePos.y}, sf::Color(139, 69, 19, 200)}
         };
         sf::Vertex rightBand[] = {
             sf::Vertex{{objectPos.x + 10, objectPos.y}, sf::Color(139, 69, 19, 200)},
-            sf::Vertex{{static_cast<float>(mousePos.x), static_cast<float>(mousePos.y)}, sf::Color(139, 69, 19, 200)}
+            sf::Vertex{{mousePos.x, mousePos.y}, sf::Color(139, 69, 19, 200)}
         };
         
         window.draw(leftBand, 2, sf::PrimitiveType::Lines);
@@ -375,36 +475,12 @@ void Application::renderTrajectory() {
         // Draw a line showing pull direction and power
         sf::Vertex pullLine[] = {
             sf::Vertex{{objectPos.x, objectPos.y}, sf::Color(255, 100, 100, 150)},
-            sf::Vertex{{static_cast<float>(mousePos.x), static_cast<float>(mousePos.y)}, sf::Color(255, 100, 100, 150)}
+            sf::Vertex{{mousePos.x, mousePos.y}, sf::Color(255, 100, 100, 150)}
         };
         window.draw(pullLine, 2, sf::PrimitiveType::Lines);
     }
     
-    // Draw trajectory as dotted line with circles
-    for (size_t i = 0; i < predictedTrajectory.size(); ++i) {
-        // Draw a dot every few points
-        if (i % 3 == 0) {
-            const Vector2D& point = predictedTrajectory[i];
-            
-            // Fade alpha based on distance along trajectory
-            std::uint8_t alpha = static_cast<std::uint8_t>(200 - (i * 150 / predictedTrajectory.size()));
-            
-            // Draw small circle
-            sf::CircleShape dot(3.0f);
-            dot.setPosition({point.x - 3.0f, point.y - 3.0f});
-            dot.setFillColor(sf::Color(255, 255, 100, alpha)); // Yellow with fade
-            window.draw(dot);
-        }
-    }
-    
-    // Also draw the curve as a line strip for smoothness
-    sf::VertexArray curve(sf::PrimitiveType::LineStrip);
-    for (size_t i = 0; i < predictedTrajectory.size(); ++i) {
-        std::uint8_t alpha = static_cast<std::uint8_t>(180 - (i * 120 / predictedTrajectory.size()));
-        curve.append(sf::Vertex{{predictedTrajectory[i].x, predictedTrajectory[i].y}, 
-                                sf::Color(255, 220, 100, alpha)});
-    }
-    window.draw(curve);
+    renderer->renderPrediction(snapshot->trajectory);
 }
 
 } // namespace Physica (renamed to vectorverse)
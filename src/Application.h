@@ -1,20 +1,17 @@
 #pragma once
-#include "PhysicsEngine.h"
+#include "EnergyGraph.h"
+#include "EnergyHistory.h"
+#include "PhysicsThread.h"
+#include "ReplayPlayer.h"
 #include "Renderer.h"
 #include <SFML/Graphics.hpp>
+#include <chrono>
 #include <memory>
+#include <optional>
 #include <vector>
-#include <deque>
 
 namespace Physica {
 
-struct EnergyData {
-    float time;
-    float kinetic;
-    float potential;
-    float total;
-};
-
 enum class SimulationModule {
     Sandbox,
     ProjectileMotion,
@@ -34,28 +31,38 @@ private:
     // Window and rendering
     sf::RenderWindow window;
     std::unique_ptr<Renderer> renderer;
+    sf::View worldView;  // Zoomed and panned view of the simulation
     
-    // Physics
-    std::unique_ptr<PhysicsEngine> physicsEngine;
+    // Physics runs on its own thread; the frame reads its latest snapshot
+    // and draws positions interpolated between its last two steps
+    std::unique_ptr<PhysicsThread> physics;
+    const SimulationSnapshot* snapshot = nullptr;
+    AlignedVector<Vector2D> drawPositions;
+    
+    // Replay playback: while a replay is open physics is paused and
+    // frames come from the file at the recorded step rate
+    std::unique_ptr<ReplayPlayer> replay;
+    float replayClock = 0.0f;
+    std::chrono::steady_clock::time_point lastFrame;
     
     // Simulation state
     bool isPaused;
-    bool isStepping;
     float simulationSpeed;
-    float timeAccumulator;
-    float fixedTimeStep;
-    float elapsedTime;
     
     // User interaction
-    std::shared_ptr<PhysicsObject> selectedObject;
+    std::optional<BodyHandle> selectedObject;
     Vector2D mouseOffset;
     bool isDragging;
     Vector2D dragStartPos;
-    std::vector<Vector2D> predictedTrajectory;
+    Vector2D launchVelocity;
+    bool trajectoryDirty = false;  // Predict again at the next frame
+    bool isPanning = false;
+    sf::Vector2i panLastPixel;
     
     // Energy tracking
-    std::deque<EnergyData> energyHistory;
-    size_t maxEnergyHistory;
+    EnergyHistory energyHistory;
+    EnergyGraph energyGraph;
+    std::vector<EnergySample> energySamples;
     
     // UI state
     bool showUI;
@@ -64,7 +71,7 @@ private:
     
     // Methods
     void processEvents();
-    void update(float dt);
+    void update();
     void render();
     void renderUI();
     void renderEnergyGraph();
@@ -74,9 +81,14 @@ private:
     void handleMouseRelease();
     void handleMouseMove(const sf::Vector2i& mousePos);
     void handleKeyPress(sf::Keyboard::Key key);
+    void toggleReplay();
+    
+    // View control: mouse wheel zooms about the cursor, middle drag pans
+    Vector2D toWorld(const sf::Vector2i& pixel) const;
+    void zoomView(float factor, const sf::Vector2i& pixel);
     
     // Object selection
-    std::shared_ptr<PhysicsObject> getObjectAtPosition(const Vector2D& pos);
+    std::optional<size_t> getObjectAtPosition(const Vector2D& pos) const;
     
     // Module loading
     void loadModule(SimulationModule module);
@@ -88,8 +100,8 @@ private:
     
     // Helpers
     void createObject(const Vector2D& position, float mass, const Vector2D& velocity = Vector2D(0, 0));
+    void addObject(const PhysicsObject& object);
     void updateEnergyTracking();
-    void calculateTrajectory(const Vector2D& startPos, const Vector2D& velocity, float mass);
     void renderTrajectory();
 };
 
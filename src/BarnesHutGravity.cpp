@@ -0,0 +1,214 @@
+#include "BarnesHutGravity.h"
+#include <algorithm>
+#include <cmath>
+
+namespace Physica {
+
+namespace {
+
+// Deeper than this, bodies are (nearly) coincident and share one leaf
+constexpr int kMaxDepth = 32;
+
+// Each body walks hundreds of nodes, so small chunks still pay off. The
+// potential is summed per block of this many bodies, then over the blocks
+// in order, so it does not depend on how the pool splits the work.
+constexpr size_t kMinBodiesPerWalk = 256;
+
+// Attraction of a point mass at `offset` from the body, and its potential
+inline void addPointMass(Vector2D offset, float mass, float softeningSquared, Vector2D& acceleration,
+                         float& potential) {
+    float inverseDistance = 1.0f / std::sqrt(offset.x * offset.x + offset.y * offset.y + softeningSquared);
+    float massOverDistance = mass * inverseDistance;
+    acceleration += offset * (massOverDistance * inverseDistance * inverseDistance);
+    potential -= massOverDistance;
+}
+
+} // namespace
+
+void BarnesHutGravity::build(const BodyStorage& bodies) {
+    nodes.clear();
+    treeBodies.clear();
+    const size_t count = bodies.size();
+    if (count == 0) return;
+
+    Vector2D lower = bodies.position[0];
+    Vector2D upper = bodies.position[0];
+    treeBodies.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        const Vector2D& position = bodies.position[i];
+        treeBodies[i] = {position, bodies.mass[i], static_cast<std::uint32_t>(i)};
+        lower.x = std::min(lower.x, position.x);
+        lower.y = std::min(lower.y, position.y);
+        upper.x = std::max(upper.x, position.x);
+        upper.y = std::max(upper.y, position.y);
+    }
+
+    // Square root cell, padded so bodies on the upper edge fall inside
+    float size = std::max(upper.x - lower.x, upper.y - lower.y) * 1.001f + 1.0f;
+    Vector2D center = (lower + upper) * 0.5f;
+    buildNode(0, static_cast<std::uint32_t>(count), center, size, 0);
+}
+
+std::uint32_t BarnesHutGravity::buildNode(std::uint32_t begin, std::uint32_t end, Vector2D center, float size,
+                                          int depth) {
+    const std::uint32_t nodeIndex = static_cast<std::uint32_t>(nodes.size());
+    nodes.emplace_back();
+
+    Node node;
+    node.size = size;
+    node.bodyBegin = begin;
+    node.bodyEnd = end;
+    node.leaf = end - begin <= leafSize || depth >= kMaxDepth;
+
+    float mass = 0.0f;
+    Vector2D weighted(0, 0);
+    if (node.leaf) {
+        for (std::uint32_t i = begin; i < end; ++i) {
+            mass += treeBodies[i].mass;
+            weighted += treeBodies[i].position * treeBodies[i].mass;
+        }
+    } else {
+        // Split into quadrants in place: top (smaller y) then bottom, each
+        // left then right
+        auto first = treeBodies.begin() + begin;
+        auto last = treeBodies.begin() + end;
+        auto bottom = std::partition(first, last, [&](const TreeBody& b) { return b.position.y < center.y; });
+        auto topRight = std::partition(first, bottom, [&](const TreeBody& b) { return b.position.x < center.x; });
+        auto bottomRight = std::partition(bottom, last, [&](const TreeBody& b) { return b.position.x < center.x; });
+
+        const auto offset = [&](decltype(first) it) { return static_cast<std::uint32_t>(it - treeBodies.begin()); };
+        const std::uint32_t bounds[5] = {begin, offset(topRight), offset(bottom), offset(bottomRight), end};
+        const float quarter = size * 0.25f;
+        const Vector2D childCenters[4] = {
+            Vector2D(center.x - quarter, center.y - quarter),
+            Vector2D(center.x + quarter, center.y - quarter),
+            Vector2D(center.x - quarter, center.y + quarter),
+            Vector2D(center.x + quarter, center.y + quarter),
+        };
+        for (int quadrant = 0; quadrant < 4; ++quadrant) {
+            if (bounds[quadrant] == bounds[quadrant + 1]) continue;
+            std::uint32_t child = buildNode(bounds[quadrant], bounds[quadrant + 1], childCenters[quadrant],
+                                            size * 0.5f, depth + 1);
+            mass += nodes[child].mass;
+            weighted += nodes[child].centerOfMass * nodes[child].mass;
+        }
+    }
+
+    node.mass = mass;
+    node.centerOfMass = mass > 0.0f ? weighted / mass : center;
+    node.next = static_cast<std::uint32_t>(nodes.size());
+    nodes[nodeIndex] = node;
+    return nodeIndex;
+}
+
+double BarnesHutGravity::accumulate(BodyStorage& bodies, size_t begin, size_t end) const {
+    const float thetaSquared = theta * theta;
+    const float softeningSquared = softening * softening;
+    const std::uint32_t nodeCount = static_cast<std::uint32_t>(nodes.size());
+    double potentialSum = 0.0;
+
+    for (size_t self = begin; self < end; ++self) {
+        const TreeBody& body = treeBodies[self];
+        Vector2D acceleration(0, 0);
+        float potential = 0.0f;
+
+        std::uint32_t current = 0;
+        while (current < nodeCount) {
+            const Node& node = nodes[current];
+            if (node.leaf) {
+                for (std::uint32_t i = node.bodyBegin; i < node.bodyEnd; ++i) {
+                    if (i == self) continue;
+                    addPointMass(treeBodies[i].position - body.position, treeBodies[i].mass, softeningSquared,
+                                 acceleration, potential);
+                }
+                current = node.next;
+                continue;
+            }
+
+            // A node holding the body itself is always opened, or at large
+            // theta the body would be pulled by its own mass
+            Vector2D offset = node.centerOfMass - body.position;
+            float distanceSquared = offset.x * offset.x + offset.y * offset.y;
+            bool holdsSelf = self >= node.bodyBegin && self < node.bodyEnd;
+            if (!holdsSelf && node.size * node.size < thetaSquared * distanceSquared) {
+                addPointMass(offset, node.mass, softeningSquared, acceleration, potential);
+                current = node.next;
+            } else {
+                current = current + 1;  // Open: first child follows
+            }
+        }
+
+        // Each pair's potential is seen from both ends, hence the half
+        potentialSum += 0.5 * gravitationalConstant * body.mass * potential;
+        if (bodies.invMass[body.index] != 0.0f) {
+            bodies.force[body.index] += acceleration * (gravitationalConstant * body.mass);
+        }
+    }
+    return potentialSum;
+}
+
+void BarnesHutGravity::apply(BodyStorage& bodies, ThreadPool& pool) {
+    build(bodies);
+
+    const size_t count = treeBodies.size();
+    blockPotentials.resize((count + kMinBodiesPerWalk - 1) / kMinBodiesPerWalk);
+    pool.parallelFor(count, kMinBodiesPerWalk, kMinBodiesPerWalk, [&](size_t begin, size_t end) {
+        for (size_t block = begin; block < end; block += kMinBodiesPerWalk) {
+            const size_t blockEnd = std::min(end, block + kMinBodiesPerWalk);
+            blockPotentials[block / kMinBodiesPerWalk] = accumulate(bodies, block, blockEnd);
+        }
+    });
+    potentialEnergy = sumBlockPotentials();
+}
+
+void BarnesHutGravity::applyDirect(BodyStorage& bodies, ThreadPool& pool) {
+    const float softeningSquared = softening * softening;
+    const size_t count = bodies.size();
+
+    blockPotentials.resize((count + kMinBodiesPerWalk - 1) / kMinBodiesPerWalk);
+    pool.parallelFor(count, kMinBodiesPerWalk, kMinBodiesPerWalk, [&](size_t begin, size_t end) {
+        double partial = 0.0;
+        for (size_t i = begin; i < end; ++i) {
+            Vector2D acceleration(0, 0);
+            float potential = 0.0f;
+            for (size_t j = 0; j < count; ++j) {
+                if (j == i) continue;
+                addPointMass(bodies.position[j] - bodies.position[i], bodies.mass[j], softeningSquared,
+                             acceleration, potential);
+            }
+            partial += 0.5 * gravitationalConstant * bodies.mass[i] * potential;
+            if (bodies.invMass[i] != 0.0f) {
+                bodies.force[i] += acceleration * (gravitationalConstant * bodies.mass[i]);
+            }
+            // Chunks hold whole blocks, so a block ends at a multiple of
+            // the block size or at the last body
+            if ((i + 1) % kMinBodiesPerWalk == 0 || i + 1 == end) {
+                blockPotentials[i / kMinBodiesPerWalk] = partial;
+                partial = 0.0;
+            }
+        }
+    });
+    potentialEnergy = sumBlockPotentials();
+}
+
+double BarnesHutGravity::sumBlockPotentials() const {
+    double total = 0.0;
+    for (double block : blockPotentials) {
+        total += block;
+    }
+    return total;
+}
+
+Vector2D BarnesHutGravity::directForce(const BodyStorage& bodies, size_t index) const {
+    const float softeningSquared = softening * softening;
+    Vector2D acceleration(0, 0);
+    float potential = 0.0f;
+    for (size_t j = 0; j < bodies.size(); ++j) {
+        if (j == index) continue;
+        addPointMass(bodies.position[j] - bodies.position[index], bodies.mass[j], softeningSquared, acceleration,
+                     potential);
+    }
+    return acceleration * (gravitationalConstant * bodies.mass[index]);
+}
+
+} // namespace Physica
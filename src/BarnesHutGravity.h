@@ -0,0 +1,80 @@
+#pragma once
+#include "BodyStorage.h"
+#include "ThreadPool.h"
+#include "Vector2D.h"
+#include <cstdint>
+#include <vector>
+
+namespace Physica {
+
+enum class GravityMode {
+    Uniform,  // The engine's gravity vector pulls every body the same way
+    Mutual    // Every body attracts every other (N-body)
+};
+
+// Mutual gravitation approximated with a Barnes-Hut quadtree.
+// The tree is rebuilt from scratch every step over a copy of the bodies
+// sorted into tree order; nodes and bodies live in flat arrays that keep
+// their capacity between steps. Nodes are stored depth first, so a node's
+// first child follows it and `next` skips its subtree, and the walk needs
+// no stack. A node whose size seen from the body is below theta is treated
+// as a point mass at its center of mass, unless it holds the body itself;
+// leaves are summed body by body.
+// Forces use Plummer softening: 1 / (r^2 + softening^2)^(3/2).
+class BarnesHutGravity {
+public:
+    float gravitationalConstant = 1000.0f;
+    float theta = 0.5f;       // Opening angle: larger is faster and less exact, 0 is exact
+    float softening = 10.0f;  // Pixels; keeps close encounters finite
+    size_t leafSize = 8;      // Most bodies summed directly in one leaf
+
+    // Rebuilds the tree over the current positions of all bodies. Static
+    // bodies attract like any other.
+    void build(const BodyStorage& bodies);
+
+    // Adds the tree's attraction to the force of dynamic bodies [begin, end)
+    // in tree order (not body index order: neighbours in tree order walk
+    // similar nodes). Returns the potential energy share of those bodies.
+    double accumulate(BodyStorage& bodies, size_t begin, size_t end) const;
+
+    // Builds the tree and adds the attraction on every dynamic body
+    void apply(BodyStorage& bodies, ThreadPool& pool);
+
+    // Reference: exact O(n^2) pairwise sum with the same softening, added to
+    // the force of every dynamic body
+    void applyDirect(BodyStorage& bodies, ThreadPool& pool);
+
+    // Exact attraction on one body, O(n)
+    Vector2D directForce(const BodyStorage& bodies, size_t index) const;
+
+    // Total potential energy found by the last apply or applyDirect
+    double getPotentialEnergy() const { return potentialEnergy; }
+    size_t getNodeCount() const { return nodes.size(); }
+
+private:
+    struct Node {
+        Vector2D centerOfMass;
+        float mass;
+        float size;                // Side of the node's square
+        std::uint32_t next;        // First node after this subtree
+        std::uint32_t bodyBegin;   // Bodies of the subtree, in tree order
+        std::uint32_t bodyEnd;
+        bool leaf;
+    };
+
+    struct TreeBody {
+        Vector2D position;
+        float mass;
+        std::uint32_t index;  // Index in BodyStorage
+    };
+
+    std::vector<Node> nodes;
+    std::vector<TreeBody> treeBodies;
+    std::vector<double> blockPotentials;  // Per block of bodies, summed in order
+    double potentialEnergy = 0.0;
+
+    double sumBlockPotentials() const;
+    std::uint32_t buildNode(std::uint32_t begin, std::uint32_t end, Vector2D center, float size, int depth);
+};
+
+} // namespace Physica
@@ -0,0 +1,175 @@
+#include "BodyStorage.h"
+
+namespace Physica {
+
+size_t BodyStorage::add(const PhysicsObject& object) {
+    position.push_back(object.position);
+    velocity.push_back(object.velocity);
+    force.push_back(object.forceAccumulator);
+    previousPosition.push_back(object.previousPosition);
+    invMass.push_back(object.getInverseMass());
+    radius.push_back(object.radius);
+    restitution.push_back(object.restitution);
+    mass.push_back(object.mass);
+    friction.push_back(object.friction);
+    extents.push_back(Vector2D(object.width, object.height));
+    shape.push_back(object.shape);
+    motion.push_back(object.isStatic ? BodyMotion::Static : BodyMotion::Dynamic);
+    sleepAnchor.push_back(object.position);
+    sleepTimer.push_back(0.0f);
+    sleepIsland.push_back(0);
+    bullet.push_back(object.isBullet);
+    appearance.push_back({object.colorR, object.colorG, object.colorB, object.label});
+    bodySlot.push_back(allocateSlot(static_cast<std::uint32_t>(position.size() - 1)));
+    return position.size() - 1;
+}
+
+void BodyStorage::remove(size_t index) {
+    if (index >= size()) return;
+
+    releaseSlot(bodySlot[index]);
+    const size_t last = size() - 1;
+    auto swapRemove = [&](auto& array) {
+        if (index != last) array[index] = std::move(array[last]);
+        array.pop_back();
+    };
+    swapRemove(position);
+    swapRemove(velocity);
+    swapRemove(force);
+    swapRemove(previousPosition);
+    swapRemove(invMass);
+    swapRemove(radius);
+    swapRemove(restitution);
+    swapRemove(mass);
+    swapRemove(friction);
+    swapRemove(extents);
+    swapRemove(shape);
+    swapRemove(motion);
+    swapRemove(sleepAnchor);
+    swapRemove(sleepTimer);
+    swapRemove(sleepIsland);
+    swapRemove(bullet);
+    swapRemove(appearance);
+    swapRemove(bodySlot);
+    if (index != last) {
+        slotBody[bodySlot[index]] = static_cast<std::uint32_t>(index);
+    }
+}
+
+void BodyStorage::clear() {
+    for (std::uint32_t slot : bodySlot) {
+        releaseSlot(slot);
+    }
+    bodySlot.clear();
+    position.clear();
+    velocity.clear();
+    force.clear();
+    previousPosition.clear();
+    invMass.clear();
+    radius.clear();
+    restitution.clear();
+    mass.clear();
+    friction.clear();
+    extents.clear();
+    shape.clear();
+    motion.clear();
+    sleepAnchor.clear();
+    sleepTimer.clear();
+    sleepIsland.clear();
+    bullet.clear();
+    appearance.clear();
+}
+
+void BodyStorage::reserve(size_t count) {
+    position.reserve(count);
+    velocity.reserve(count);
+    force.reserve(count);
+    previousPosition.reserve(count);
+    invMass.reserve(count);
+    radius.reserve(count);
+    restitution.reserve(count);
+    mass.reserve(count);
+    friction.reserve(count);
+    extents.reserve(count);
+    shape.reserve(count);
+    motion.reserve(count);
+    sleepAnchor.reserve(count);
+    sleepTimer.reserve(count);
+    sleepIsland.reserve(count);
+    bullet.reserve(count);
+    appearance.reserve(count);
+    bodySlot.reserve(count);
+    slotBody.reserve(count);
+    slotGeneration.reserve(count);
+}
+
+void BodyStorage::resetHandles() {
+    // Every slot moves to a new generation; bodies take the first slots
+    // that are not retired, and the rest are free
+    bodySlot.resize(size());
+    freeSlot = kNoSlot;
+    std::uint32_t* lastFree = &freeSlot;
+    size_t body = 0;
+    for (size_t slot = 0; slot < slotBody.size(); ++slot) {
+        if (slotGeneration[slot] == kRetired || ++slotGeneration[slot] == kRetired) {
+            slotBody[slot] = kNoSlot;
+        } else if (body < size()) {
+            slotBody[slot] = static_cast<std::uint32_t>(body);
+            bodySlot[body++] = static_cast<std::uint32_t>(slot);
+        } else {
+            *lastFree = static_cast<std::uint32_t>(slot);
+            lastFree = &slotBody[slot];
+        }
+    }
+    *lastFree = kNoSlot;
+    for (; body < size(); ++body) {
+        slotBody.push_back(static_cast<std::uint32_t>(body));
+        slotGeneration.push_back(0);
+        bodySlot[body] = static_cast<std::uint32_t>(slotBody.size() - 1);
+    }
+}
+
+std::uint32_t BodyStorage::allocateSlot(std::uint32_t index) {
+    // Slots outnumber live bodies only by the retired ones, one per 2^32
+    // releases of a slot, so a 32-bit slot runs out no sooner than the
+    // 32-bit body index does
+    if (freeSlot == kNoSlot) {
+        slotBody.push_back(index);
+        slotGeneration.push_back(0);
+        return static_cast<std::uint32_t>(slotBody.size() - 1);
+    }
+    std::uint32_t slot = freeSlot;
+    freeSlot = slotBody[slot];
+    slotBody[slot] = index;
+    return slot;
+}
+
+void BodyStorage::releaseSlot(std::uint32_t slot) {
+    if (++slotGeneration[slot] == kRetired) {
+        slotBody[slot] = kNoSlot;
+        return;
+    }
+    slotBody[slot] = freeSlot;
+    freeSlot = slot;
+}
+
+PhysicsObject BodyStorage::toObject(size_t index) const {
+    PhysicsObject object(position[index], mass[index], shape[index]);
+    object.velocity = velocity[index];
+    object.previousPosition = previousPosition[index];
+    object.forceAccumulator = force[index];
+    object.radius = radius[index];
+    object.width = extents[index].x;
+    object.height = extents[index].y;
+    object.restitution = restitution[index];
+    object.friction = friction[index];
+    object.isStatic = motion[index] == BodyMotion::Static;
+    object.isBullet = bullet[index] != 0;
+    object.colorR = appearance[index].colorR;
+    object.colorG = appearance[index].colorG;
+    object.colorB = appearance[index].colorB;
+    object.label = appearance[index].label;
+    return object;
+}
+
+} // namespace Physica
@@ -0,0 +1,188 @@
+#pragma once
+#include "PhysicsObject.h"
+#include "AlignedAllocator.h"
+#include <vector>
+#include <string>
+#include <optional>
+#include <cstddef>
+#include <cstdint>
+
+namespace Physica {
+
+// Bodies whose float fields fill one cache line; parallel loops split
+// body ranges on multiples of this so threads never share a line
+constexpr size_t kBodiesPerCacheLine = kCacheLineSize / sizeof(float);
+
+// How a body takes part in the simulation. Static and sleeping bodies both
+// have zero inverse mass, so every per-body pass already skips them.
+enum class BodyMotion : std::uint8_t {
+    Dynamic,
+    Static,
+    Sleeping
+};
+
+// Per-body data the simulation never reads (only used for drawing)
+struct BodyAppearance {
+    float colorR, colorG, colorB;
+    std::string label;
+};
+
+// Stable reference to a body in a BodyStorage, which moves bodies around
+// when others are removed: a slot in the storage's handle table (low 32
+// bits, as wide as a body index) and the slot's generation (high 32 bits).
+// Removing a body bumps the generation of its slot, so old handles to it
+// stop resolving. A slot whose generation runs out is retired instead of
+// wrapping round, so a stale handle never resolves again, however often
+// its slot is reused.
+struct BodyHandle {
+    static constexpr std::uint32_t kSlotBits = 32;
+    static constexpr std::uint64_t kSlotMask = (std::uint64_t(1) << kSlotBits) - 1;
+
+    std::uint64_t value = 0;
+
+    std::uint32_t slot() const { return static_cast<std::uint32_t>(value & kSlotMask); }
+    std::uint32_t generation() const { return static_cast<std::uint32_t>(value >> kSlotBits); }
+    bool operator==(const BodyHandle& other) const { return value == other.value; }
+    bool operator!=(const BodyHandle& other) const { return value != other.value; }
+};
+
+// Structure-of-arrays storage for every body in the engine.
+// Each physics pass streams through only the arrays it needs; labels and
+// colors live in a side table so they never pollute the cache.
+// Arrays start on cache line boundaries. A body is static when its
+// inverse mass is zero.
+// Bodies stay packed: remove() moves the last body into the hole, so
+// indices are only stable until the next removal. Handles stay valid until
+// their body is removed; adding and removing never allocates once the
+// arrays and the handle table have grown to the peak body count.
+class BodyStorage {
+public:
+    size_t size() const { return position.size(); }
+    bool empty() const { return position.empty(); }
+
+    size_t add(const PhysicsObject& object);
+    void remove(size_t index);  // O(1): the last body takes its place
+    void clear();
+    void reserve(size_t count);
+
+    BodyHandle handle(size_t index) const {
+        std::uint32_t slot = bodySlot[index];
+        return BodyHandle{std::uint64_t(slotGeneration[slot]) << BodyHandle::kSlotBits | slot};
+    }
+    // Current index of the body, or nothing once it has been removed
+    std::optional<size_t> find(BodyHandle handle) const {
+        std::uint32_t slot = handle.slot();
+        if (slot >= slotBody.size() || slotGeneration[slot] != handle.generation()) return std::nullopt;
+        std::uint32_t index = slotBody[slot];
+        if (index >= size() || bodySlot[index] != slot) return std::nullopt;
+        return index;
+    }
+    // Gives every body a fresh handle and invalidates all earlier ones.
+    // Call after replacing the body arrays wholesale.
+    void resetHandles();
+
+    // Rebuild a standalone PhysicsObject from the stored state
+    PhysicsObject toObject(size_t index) const;
+
+    // Half size of the axis-aligned bounding box
+    Vector2D halfExtents(size_t index) const {
+        return shape[index] == ShapeType::Circle ? Vector2D(radius[index], radius[index])
+                                                 : extents[index] * 0.5f;
+    }
+
+    // Radius of the smallest circle enclosing the body
+    float boundingRadius(size_t index) const {
+        return shape[index] == ShapeType::Circle ? radius[index] : halfExtents(index).magnitude();
+    }
+
+    // Hot state (read or written every step)
+    AlignedVector<Vector2D> position;
+    AlignedVector<Vector2D> velocity;
+    AlignedVector<Vector2D> force;
+    AlignedVector<Vector2D> previousPosition; // Where the last Verlet step started
+    AlignedVector<float> invMass;
+    AlignedVector<float> radius;
+    AlignedVector<float> restitution;
+
+    // Warm state (read by a few passes)
+    AlignedVector<float> mass;
+    AlignedVector<float> friction;
+    AlignedVector<Vector2D> extents; // Width and height for boxes
+    AlignedVector<ShapeType> shape;
+    AlignedVector<BodyMotion> motion;
+    AlignedVector<Vector2D> sleepAnchor;      // Where the current rest period started
+    AlignedVector<float> sleepTimer;          // Seconds spent near the anchor
+    AlignedVector<std::uint32_t> sleepIsland; // Island a sleeping body went to sleep with
+    AlignedVector<std::uint8_t> bullet;       // Nonzero: always swept by continuous collision
+
+    // Cold state
+    std::vector<BodyAppearance> appearance;
+
+private:
+    static constexpr std::uint32_t kNoSlot = 0xffffffff;
+    // Generation of a slot that is never handed out again
+    static constexpr std::uint32_t kRetired = 0xffffffff;
+
+    // Handle table: the slot of each body, and per slot the body it names
+    // (or, for a free slot, the next free slot) and its generation
+    std::vector<std::uint32_t> bodySlot;
+    std::vector<std::uint32_t> slotBody;
+    std::vector<std::uint32_t> slotGeneration;
+    std::uint32_t freeSlot = kNoSlot;
+
+    std::uint32_t allocateSlot(std::uint32_t index);
+    void releaseSlot(std::uint32_t slot);
+};
+
+// Lightweight handle to one body inside a BodyStorage.
+// Storage is either BodyStorage or const BodyStorage.
+template <typename Storage>
+class BodyView {
+public:
+    BodyView(Storage& storage, size_t index) : storage(&storage), idx(index) {}
+
+    // Allow BodyRef -> ConstBodyRef
+    template <typename Other>
+    BodyView(const BodyView<Other>& other) : storage(&other.getStorage()), idx(other.index()) {}
+
+    size_t index() const { return idx; }
+    Storage& getStorage() const { return *storage; }
+
+    auto& position() const { return storage->position[idx]; }
+    auto& velocity() const { return storage->velocity[idx]; }
+    auto& force() const { return storage->force[idx]; }
+    auto& previousPosition() const { return storage->previousPosition[idx]; }
+    auto& radius() const { return storage->radius[idx]; }
+    auto& restitution() const { return storage->restitution[idx]; }
+    auto& friction() const { return storage->friction[idx]; }
+    auto& shape() const { return storage->shape[idx]; }
+    auto& appearance() const { return storage->appearance[idx]; }
+
+    float mass() const { return storage->mass[idx]; }
+    float inverseMass() const { return storage->invMass[idx]; }
+    bool isStatic() const { return storage->motion[idx] == BodyMotion::Static; }
+    bool isSleeping() const { return storage->motion[idx] == BodyMotion::Sleeping; }
+    float width() const { return storage->extents[idx].x; }
+    float height() const { return storage->extents[idx].y; }
+
+    // Mass and motion both feed the cached inverse mass
+    void setMass(float m) const {
+        storage->mass[idx] = m;
+        if (storage->motion[idx] == BodyMotion::Dynamic) storage->invMass[idx] = 1.0f / m;
+    }
+
+    void setStatic(bool value) const {
+        storage->motion[idx] = value ? BodyMotion::Static : BodyMotion::Dynamic;
+        storage->invMass[idx] = value ? 0.0f : 1.0f / storage->mass[idx];
+        storage->sleepTimer[idx] = 0.0f;
+    }
+
+private:
+    Storage* storage;
+    size_t idx;
+};
+
+using BodyRef = BodyView<BodyStorage>;
+using ConstBodyRef = BodyView<const BodyStorage>;
+
+} // namespace Physica
@@ -0,0 +1,320 @@
+#include "Broadphase.h"
+#include <algorithm>
+#include <cmath>
+
+namespace Physica {
+
+namespace {
+
+// A dense grid is used while it needs at most this many cells per body
+constexpr size_t kMinCells = 1024;
+constexpr size_t kCellsPerBody = 4;
+
+// Keeps cell coordinates far from integer overflow for runaway bodies
+constexpr float kMaxCellCoord = 1 << 30;
+
+} // namespace
+
+void UniformGridBroadphase::findPairs(const BodyStorage& bodies, std::vector<BodyPair>& pairs) {
+    pairs.clear();
+    if (bodies.size() < 2) return;
+
+    build(bodies);
+    if (hashed) {
+        emitHashedPairs(bodies, pairs);
+    } else {
+        emitDensePairs(bodies, pairs);
+    }
+}
+
+void UniformGridBroadphase::build(const BodyStorage& bodies) {
+    const size_t count = bodies.size();
+    if (count == 0) {
+        hashed = false;
+        columns = rows = 0;
+        sorted.clear();
+        cellX.clear();
+        cellY.clear();
+        return;
+    }
+
+    // Bounds of all body centers
+    float maxRadius = 0.0f;
+    Vector2D minPos = bodies.position[0];
+    Vector2D maxPos = minPos;
+    for (size_t i = 0; i < count; ++i) {
+        const Vector2D& p = bodies.position[i];
+        minPos.x = std::min(minPos.x, p.x);
+        minPos.y = std::min(minPos.y, p.y);
+        maxPos.x = std::max(maxPos.x, p.x);
+        maxPos.y = std::max(maxPos.y, p.y);
+        maxRadius = std::max(maxRadius, bodies.boundingRadius(i));
+    }
+
+    // Cell coordinates relative to the lower bound
+    origin = minPos;
+    cellSize = std::max(2.0f * maxRadius + margin, 1.0f);
+    float invCell = 1.0f / cellSize;
+    cellX.resize(count);
+    cellY.resize(count);
+    for (size_t k = 0; k < count; ++k) {
+        Vector2D local = (bodies.position[k] - minPos) * invCell;
+        cellX[k] = static_cast<int>(std::min(local.x, kMaxCellCoord));
+        cellY[k] = static_cast<int>(std::min(local.y, kMaxCellCoord));
+    }
+
+    // Dense grid when it stays small, otherwise a spatial hash
+    Vector2D span = (maxPos - minPos) * invCell;
+    size_t maxCells = std::max(kMinCells, count * kCellsPerBody);
+    hashed = (span.x + 1.0f) * (span.y + 1.0f) > static_cast<float>(maxCells);
+    size_t bucketCount;
+    if (hashed) {
+        bucketCount = 1;
+        while (bucketCount < count * 2) bucketCount <<= 1;
+        hashMask = static_cast<std::uint32_t>(bucketCount - 1);
+    } else {
+        columns = static_cast<int>(span.x) + 1;
+        rows = static_cast<int>(span.y) + 1;
+        bucketCount = static_cast<size_t>(columns) * rows;
+    }
+
+    // Counting sort of bodies by bucket
+    bucketStart.assign(bucketCount + 1, 0);
+    bucketOf.resize(count);
+    for (size_t k = 0; k < count; ++k) {
+        std::uint32_t bucket = hashed ? hashCell(cellX[k], cellY[k])
+                                      : static_cast<std::uint32_t>(cellY[k] * columns + cellX[k]);
+        bucketOf[k] = bucket;
+        ++bucketStart[bucket + 1];
+    }
+    for (size_t c = 0; c < bucketCount; ++c) {
+        bucketStart[c + 1] += bucketStart[c];
+    }
+    sorted.resize(count);
+    for (size_t k = 0; k < count; ++k) {
+        // bucketStart[bucket] is used as the write cursor and restored below
+        sorted[bucketStart[bucketOf[k]]++] = static_cast<std::uint32_t>(k);
+    }
+    for (size_t c = bucketCount; c > 0; --c) {
+        bucketStart[c] = bucketStart[c - 1];
+    }
+    bucketStart[0] = 0;
+}
+
+void UniformGridBroadphase::query(const Vector2D& min, const Vector2D& max, std::vector<std::uint32_t>& out) const {
+    if (sorted.empty() || !(min.x <= max.x && min.y <= max.y)) return;
+
+    // Bodies are binned by center and reach at most half a cell out, so
+    // one extra ring of cells covers every body touching the box
+    float invCell = 1.0f / cellSize;
+    Vector2D low = (min - origin) * invCell;
+    Vector2D high = (max - origin) * invCell;
+    int x0 = static_cast<int>(std::floor(std::max(low.x, -kMaxCellCoord))) - 1;
+    int y0 = static_cast<int>(std::floor(std::max(low.y, -kMaxCellCoord))) - 1;
+    int x1 = static_cast<int>(std::floor(std::min(high.x, kMaxCellCoord))) + 1;
+    int y1 = static_cast<int>(std::floor(std::min(high.y, kMaxCellCoord))) + 1;
+
+    if (!hashed) {
+        x0 = std::max(x0, 0);
+        y0 = std::max(y0, 0);
+        x1 = std::min(x1, columns - 1);
+        y1 = std::min(y1, rows - 1);
+        for (int cy = y0; cy <= y1; ++cy) {
+            for (int cx = x0; cx <= x1; ++cx) {
+                std::uint32_t cell = static_cast<std::uint32_t>(cy * columns + cx);
+                out.insert(out.end(), sorted.begin() + bucketStart[cell], sorted.begin() + bucketStart[cell + 1]);
+            }
+        }
+        return;
+    }
+
+    // A box wider than the table is cheaper to test body by body
+    if (static_cast<double>(x1 - x0 + 1) * (y1 - y0 + 1) > static_cast<double>(sorted.size())) {
+        for (std::uint32_t k = 0; k < cellX.size(); ++k) {
+            if (cellX[k] >= x0 && cellX[k] <= x1 && cellY[k] >= y0 && cellY[k] <= y1) out.push_back(k);
+        }
+        return;
+    }
+    for (int cy = y0; cy <= y1; ++cy) {
+        for (int cx = x0; cx <= x1; ++cx) {
+            std::uint32_t bucket = hashCell(cx, cy);
+            for (std::uint32_t j = bucketStart[bucket]; j < bucketStart[bucket + 1]; ++j) {
+                std::uint32_t k = sorted[j];
+                if (cellX[k] == cx && cellY[k] == cy) out.push_back(k);
+            }
+        }
+    }
+}
+
+std::uint32_t UniformGridBroadphase::hashCell(int cx, int cy) const {
+    std::uint32_t h = static_cast<std::uint32_t>(cx) * 73856093u ^ static_cast<std::uint32_t>(cy) * 19349663u;
+    return h & hashMask;
+}
+
+void UniformGridBroadphase::emitDensePairs(const BodyStorage& bodies, std::vector<BodyPair>& pairs) const {
+    // Visit each cell with itself and four forward neighbours so every
+    // adjacent cell pair is tested exactly once
+    for (int cy = 0; cy < rows; ++cy) {
+        for (int cx = 0; cx < columns; ++cx) {
+            std::uint32_t cell = static_cast<std::uint32_t>(cy * columns + cx);
+            if (bucketStart[cell] == bucketStart[cell + 1]) continue;
+
+            emitBucketPairs(bodies, cell, cell, pairs);
+            if (cx + 1 < columns) emitBucketPairs(bodies, cell, cell + 1, pairs);
+            if (cy + 1 < rows) {
+                if (cx > 0) emitBucketPairs(bodies, cell, cell + columns - 1, pairs);
+                emitBucketPairs(bodies, cell, cell + columns, pairs);
+                if (cx + 1 < columns) emitBucketPairs(bodies, cell, cell + columns + 1, pairs);
+            }
+        }
+    }
+}
+
+void UniformGridBroadphase::emitBucketPairs(const BodyStorage& bodies, std::uint32_t bucket,
+                                            std::uint32_t otherBucket, std::vector<BodyPair>& pairs) const {
+    std::uint32_t end = bucketStart[bucket + 1];
+    std::uint32_t otherEnd = bucketStart[otherBucket + 1];
+
+    for (std::uint32_t i = bucketStart[bucket]; i < end; ++i) {
+        std::uint32_t a = sorted[i];
+        // Within a cell, only pair with later entries
+        std::uint32_t j = (bucket == otherBucket) ? i + 1 : bucketStart[otherBucket];
+        for (; j < otherEnd; ++j) {
+            emitPair(bodies, a, sorted[j], pairs);
+        }
+    }
+}
+
+void UniformGridBroadphase::emitHashedPairs(const BodyStorage& bodies, std::vector<BodyPair>& pairs) const {
+    // Different cells can share a bucket, so each body queries its 3x3
+    // neighbourhood and keeps only entries whose exact cell matches.
+    // Pairing with higher indices only reports each pair once.
+    const size_t count = cellX.size();
+    for (std::uint32_t ka = 0; ka < count; ++ka) {
+        for (int dy = -1; dy <= 1; ++dy) {
+            for (int dx = -1; dx <= 1; ++dx) {
+                int nx = cellX[ka] + dx;
+                int ny = cellY[ka] + dy;
+                std::uint32_t bucket = hashCell(nx, ny);
+                for (std::uint32_t j = bucketStart[bucket]; j < bucketStart[bucket + 1]; ++j) {
+                    std::uint32_t kb = sorted[j];
+                    if (kb <= ka || cellX[kb] != nx || cellY[kb] != ny) continue;
+                    emitPair(bodies, ka, kb, pairs);
+                }
+            }
+        }
+    }
+}
+
+void UniformGridBroadphase::emitPair(const BodyStorage& bodies, std::uint32_t a, std::uint32_t b,
+                                     std::vector<BodyPair>& pairs) const {
+    // Two static bodies never need resolving
+    if (bodies.invMass[a] == 0.0f && bodies.invMass[b] == 0.0f) return;
+    pairs.push_back(a < b ? BodyPair{a, b} : BodyPair{b, a});
+}
+
+namespace {
+
+std::uint64_t pairKey(std::uint32_t a, std::uint32_t b) {
+    if (a > b) std::swap(a, b);
+    return (static_cast<std::uint64_t>(a) << 32) | b;
+}
+
+} // namespace
+
+void SweepAndPruneBroadphase::findPairs(const BodyStorage& bodies, std::vector<BodyPair>& pairs) {
+    pairs.clear();
+
+    if (!valid || trackedCount != bodies.size()) {
+        rebuild(bodies);
+    } else {
+        // Refresh endpoint values, then repair the order with an insertion sort.
+        // Every swap of a min past a max starts or ends an x overlap.
+        for (Endpoint& e : endpoints) {
+            float half = bodies.halfExtents(e.body).x;
+            e.value = bodies.position[e.body].x + (e.isMax ? half : -half);
+        }
+        for (size_t i = 1; i < endpoints.size(); ++i) {
+            Endpoint moving = endpoints[i];
+            size_t j = i;
+            while (j > 0 && endpoints[j - 1].value > moving.value) {
+                const Endpoint& passed = endpoints[j - 1];
+                if (!moving.isMax && passed.isMax) {
+                    addOverlap(moving.body, passed.body);
+                } else if (moving.isMax && !passed.isMax) {
+                    removeOverlap(moving.body, passed.body);
+                }
+                endpoints[j] = passed;
+                --j;
+            }
+            endpoints[j] = moving;
+        }
+    }
+
+    // Keep the x overlaps that also overlap on y
+    for (const BodyPair& pair : overlaps) {
+        if (bodies.invMass[pair.a] == 0.0f && bodies.invMass[pair.b] == 0.0f) continue;
+
+        float dy = std::abs(bodies.position[pair.a].y - bodies.position[pair.b].y);
+        if (dy <= bodies.halfExtents(pair.a).y + bodies.halfExtents(pair.b).y) {
+            pairs.push_back(pair);
+        }
+    }
+}
+
+void SweepAndPruneBroadphase::rebuild(const BodyStorage& bodies) {
+    const size_t count = bodies.size();
+    endpoints.clear();
+    overlaps.clear();
+    overlapIndex.clear();
+
+    for (size_t i = 0; i < count; ++i) {
+        float x = bodies.position[i].x;
+        float half = bodies.halfExtents(i).x;
+        std::uint32_t body = static_cast<std::uint32_t>(i);
+        endpoints.push_back({x - half, body, false});
+        endpoints.push_back({x + half, body, true});
+    }
+    std::sort(endpoints.begin(), endpoints.end(), [](const Endpoint& a, const Endpoint& b) {
+        return a.value < b.value || (a.value == b.value && !a.isMax && b.isMax);
+    });
+
+    // Sweep once, pairing each new interval with every open one
+    std::vector<std::uint32_t> open;
+    for (const Endpoint& e : endpoints) {
+        if (e.isMax) {
+            open.erase(std::find(open.begin(), open.end(), e.body));
+        } else {
+            for (std::uint32_t other : open) {
+                addOverlap(e.body, other);
+            }
+            open.push_back(e.body);
+        }
+    }
+
+    trackedCount = count;
+    valid = true;
+}
+
+void SweepAndPruneBroadphase::addOverlap(std::uint32_t a, std::uint32_t b) {
+    auto inserted = overlapIndex.emplace(pairKey(a, b), static_cast<std::uint32_t>(overlaps.size()));
+    if (inserted.second) {
+        overlaps.push_back(a < b ? BodyPair{a, b} : BodyPair{b, a});
+    }
+}
+
+void SweepAndPruneBroadphase::removeOverlap(std::uint32_t a, std::uint32_t b) {
+    auto it = overlapIndex.find(pairKey(a, b));
+    if (it == overlapIndex.end()) return;
+
+    // Swap-remove, fixing up the index of the pair moved into the hole
+    std::uint32_t slot = it->second;
+    overlapIndex.erase(it);
+    if (slot + 1 != overlaps.size()) {
+        overlaps[slot] = overlaps.back();
+        overlapIndex[pairKey(overlaps[slot].a, overlaps[slot].b)] = slot;
+    }
+    overlaps.pop_back();
+}
+
+} // namespace Physica
@@ -0,0 +1,99 @@
+#pragma once
+#include "BodyStorage.h"
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+
+namespace Physica {
+
+enum class BroadphaseMethod {
+    BruteForce,
+    UniformGrid,
+    SweepAndPrune
+};
+
+// Candidate pair produced by a broadphase (indices into BodyStorage, a < b)
+struct BodyPair {
+    std::uint32_t a, b;
+};
+
+// Uniform grid rebuilt from scratch every step with a counting sort.
+// Each body is binned by its center; the cell size is the largest
+// bounding diameter (plus the margin), so overlapping bodies always share
+// a cell or sit in neighbouring cells. When the bodies are spread too thin
+// for a dense grid, cells are hashed into a table sized from the body
+// count instead.
+class UniformGridBroadphase {
+public:
+    // Clears `pairs` and fills it with every potentially overlapping pair
+    void findPairs(const BodyStorage& bodies, std::vector<BodyPair>& pairs);
+
+    // Bins the bodies without looking for pairs (findPairs does this too)
+    void build(const BodyStorage& bodies);
+    // Appends every body the last build binned that may overlap the box
+    // from `min` to `max`. Nothing is allocated once `out` has grown.
+    void query(const Vector2D& min, const Vector2D& max, std::vector<std::uint32_t>& out) const;
+
+    float getCellSize() const { return cellSize; }
+    bool isHashed() const { return hashed; }
+
+    // Extra gap, in world units, across which findPairs still reports
+    // pairs: cells grow to fit the widest body plus the margin
+    float margin = 0.0f;
+
+private:
+    float cellSize = 0.0f;
+    Vector2D origin;  // Lowest body center, the corner of cell (0, 0)
+    int columns = 0;
+    int rows = 0;
+    bool hashed = false;
+    std::uint32_t hashMask = 0;
+
+    // Reused between steps so rebuilding does not allocate
+    std::vector<int> cellX, cellY;          // Cell coordinates of each body
+    std::vector<std::uint32_t> bucketOf;    // Bucket of each body
+    std::vector<std::uint32_t> bucketStart; // Prefix sums, size buckets + 1
+    std::vector<std::uint32_t> sorted;      // Body indices sorted by bucket
+
+    std::uint32_t hashCell(int cx, int cy) const;
+    void emitDensePairs(const BodyStorage& bodies, std::vector<BodyPair>& pairs) const;
+    void emitHashedPairs(const BodyStorage& bodies, std::vector<BodyPair>& pairs) const;
+    void emitBucketPairs(const BodyStorage& bodies, std::uint32_t bucket, std::uint32_t otherBucket,
+                         std::vector<BodyPair>& pairs) const;
+    void emitPair(const BodyStorage& bodies, std::uint32_t a, std::uint32_t b, std::vector<BodyPair>& pairs) const;
+};
+
+// Incremental sweep and prune along the x axis.
+// The sorted endpoint list persists between steps and is repaired with an
+// insertion sort, which is close to linear when bodies barely move. The set
+// of pairs overlapping on x only changes when a min and a max endpoint swap;
+// those pairs are filtered by their y extents when candidates are emitted.
+class SweepAndPruneBroadphase {
+public:
+    // Clears `pairs` and fills it with every pair whose bounding boxes overlap
+    void findPairs(const BodyStorage& bodies, std::vector<BodyPair>& pairs);
+
+    // Forces a full rebuild on the next call (bodies were added or removed)
+    void invalidate() { valid = false; }
+
+    size_t getOverlapCount() const { return overlaps.size(); }
+
+private:
+    struct Endpoint {
+        float value;
+        std::uint32_t body;
+        bool isMax;
+    };
+
+    std::vector<Endpoint> endpoints;
+    std::vector<BodyPair> overlaps;                        // Pairs overlapping on x
+    std::unordered_map<std::uint64_t, std::uint32_t> overlapIndex; // Pair key -> slot in overlaps
+    size_t trackedCount = 0;
+    bool valid = false;
+
+    void rebuild(const BodyStorage& bodies);
+    void addOverlap(std::uint32_t a, std::uint32_t b);
+    void removeOverlap(std::uint32_t a, std::uint32_t b);
+};
+
+} // namespace Physica
@@ -0,0 +1,138 @@
+#include "Collision.h"
+#include <algorithm>
+#include <cmath>
+
+namespace Physica {
+
+namespace {
+
+bool computeCircleCircleContact(const BodyStorage& bodies, size_t a, size_t b,
+                                Vector2D& normal, float& penetration) {
+    if (!checkCircleCircleCollision(bodies, a, b)) return false;
+
+    // One square root gives both the normal and the overlap
+    Vector2D delta = bodies.position[b] - bodies.position[a];
+    float distance = delta.magnitude();
+    normal = distance > 0.0001f ? delta / distance : Vector2D(0, 0);
+    penetration = (bodies.radius[a] + bodies.radius[b]) - distance;
+    return true;
+}
+
+bool computeCircleBoxContact(const BodyStorage& bodies, size_t circle, size_t box,
+                             Vector2D& normal, float& penetration) {
+    float radius = bodies.radius[circle];
+    Vector2D half = bodies.halfExtents(box);
+    Vector2D local = bodies.position[circle] - bodies.position[box];
+
+    // Closest point on the box to the circle center
+    Vector2D closest(std::clamp(local.x, -half.x, half.x), std::clamp(local.y, -half.y, half.y));
+    Vector2D offset = local - closest;
+    float distanceSquared = offset.magnitudeSquared();
+
+    if (distanceSquared > 0.0f) {
+        if (distanceSquared >= radius * radius) return false;
+        float distance = std::sqrt(distanceSquared);
+        normal = offset * (-1.0f / distance);
+        penetration = radius - distance;
+        return true;
+    }
+
+    // Center inside the box: push out through the nearest face
+    float faceX = half.x - std::abs(local.x);
+    float faceY = half.y - std::abs(local.y);
+    if (faceX < faceY) {
+        normal = Vector2D(local.x < 0.0f ? 1.0f : -1.0f, 0.0f);
+        penetration = faceX + radius;
+    } else {
+        normal = Vector2D(0.0f, local.y < 0.0f ? 1.0f : -1.0f);
+        penetration = faceY + radius;
+    }
+    return true;
+}
+
+bool computeBoxBoxContact(const BodyStorage& bodies, size_t a, size_t b,
+                          Vector2D& normal, float& penetration) {
+    // Separate along the axis of least overlap
+    Vector2D delta = bodies.position[b] - bodies.position[a];
+    Vector2D reach = bodies.halfExtents(a) + bodies.halfExtents(b);
+    float overlapX = reach.x - std::abs(delta.x);
+    float overlapY = reach.y - std::abs(delta.y);
+    if (overlapX <= 0.0f || overlapY <= 0.0f) return false;
+
+    if (overlapX < overlapY) {
+        normal = Vector2D(delta.x < 0.0f ? -1.0f : 1.0f, 0.0f);
+        penetration = overlapX;
+    } else {
+        normal = Vector2D(0.0f, delta.y < 0.0f ? -1.0f : 1.0f);
+        penetration = overlapY;
+    }
+    return true;
+}
+
+} // namespace
+
+bool checkCircleCircleCollision(const BodyStorage& bodies, size_t a, size_t b) {
+    float radii = bodies.radius[a] + bodies.radius[b];
+    return (bodies.position[b] - bodies.position[a]).magnitudeSquared() < radii * radii;
+}
+
+bool computeContact(const BodyStorage& bodies, size_t a, size_t b, Vector2D& normal, float& penetration) {
+    bool circleA = bodies.shape[a] == ShapeType::Circle;
+    bool circleB = bodies.shape[b] == ShapeType::Circle;
+
+    if (circleA && circleB) {
+        return computeCircleCircleContact(bodies, a, b, normal, penetration);
+    }
+    if (circleA) {
+        return computeCircleBoxContact(bodies, a, b, normal, penetration);
+    }
+    if (circleB) {
+        bool hit = computeCircleBoxContact(bodies, b, a, normal, penetration);
+        normal = normal * -1.0f;
+        return hit;
+    }
+    return computeBoxBoxContact(bodies, a, b, normal, penetration);
+}
+
+void resolveContact(BodyStorage& bodies, size_t a, size_t b, const Vector2D& normal, float overlap) {
+    float invMassA = bodies.invMass[a];
+    float invMassB = bodies.invMass[b];
+    float totalInvMass = invMassA + invMassB;
+    if (totalInvMass == 0.0f) return;
+
+    // Separate objects
+    if (overlap > 0 && totalInvMass > 0.0001f) {
+        Vector2D separation = normal * (overlap / totalInvMass);
+        if (invMassA != 0.0f) bodies.position[a] -= separation * invMassA;
+        if (invMassB != 0.0f) bodies.position[b] += separation * invMassB;
+    }
+
+    // Calculate relative velocity
+    Vector2D relativeVelocity = bodies.velocity[b] - bodies.velocity[a];
+    float velocityAlongNormal = relativeVelocity.dot(normal);
+
+    // Don't resolve if objects are separating
+    if (velocityAlongNormal > 0) return;
+
+    // Calculate restitution
+    float e = std::min(bodies.restitution[a], bodies.restitution[b]);
+
+    // Calculate impulse scalar
+    float j = -(1 + e) * velocityAlongNormal;
+    j /= totalInvMass;
+
+    // Apply impulse
+    Vector2D impulse = normal * j;
+    if (invMassA != 0.0f) bodies.velocity[a] -= impulse * invMassA;
+    if (invMassB != 0.0f) bodies.velocity[b] += impulse * invMassB;
+}
+
+void collidePair(BodyStorage& bodies, size_t a, size_t b) {
+    Vector2D normal;
+    float penetration;
+    if (computeContact(bodies, a, b, normal, penetration)) {
+        resolveContact(bodies, a, b, normal, penetration);
+    }
+}
+
+} // namespace Physica
@@ -0,0 +1,20 @@
+#pragma once
+#include "BodyStorage.h"
+
+namespace Physica {
+
+// Narrowphase and impulse response shared by the engine and the contact
+// solver. Normals always point from body a to body b.
+
+bool checkCircleCircleCollision(const BodyStorage& bodies, size_t a, size_t b);
+
+// Contact normal and penetration depth if bodies a and b overlap
+bool computeContact(const BodyStorage& bodies, size_t a, size_t b, Vector2D& normal, float& penetration);
+
+// Positional correction plus restitution impulse (static bodies are never written)
+void resolveContact(BodyStorage& bodies, size_t a, size_t b, const Vector2D& normal, float overlap);
+
+// Tests a pair against the current positions and resolves it on contact
+void collidePair(BodyStorage& bodies, size_t a, size_t b);
+
+} // namespace Physica
@@ -0,0 +1,125 @@
+#include "ContactSolver.h"
+#include "Collision.h"
+
+namespace Physica {
+
+namespace {
+
+// A 64-bit mask per body tracks its colours; contacts that find no free
+// colour go into one extra batch that is resolved serially
+constexpr std::uint8_t kMaxColors = 64;
+constexpr std::uint8_t kOverflowColor = kMaxColors;
+
+constexpr size_t kMinPairsPerChunk = 1024;
+constexpr size_t kMinContactsPerChunk = 256;
+
+} // namespace
+
+void ContactSolver::solve(BodyStorage& bodies, const std::vector<BodyPair>& candidates, ThreadPool& pool) {
+    findContacts(bodies, candidates, pool);
+    resolve(bodies, pool);
+}
+
+void ContactSolver::resolve(BodyStorage& bodies, ThreadPool& pool) {
+    if (contacts.size() < minParallelContacts) {
+        solveSerial(bodies);
+        return;
+    }
+
+    buildBatches(bodies);
+    solveBatches(bodies, pool);
+}
+
+void ContactSolver::findContacts(const BodyStorage& bodies, const std::vector<BodyPair>& candidates,
+                                 ThreadPool& pool) {
+    touching.resize(candidates.size());
+    pool.parallelFor(candidates.size(), kMinPairsPerChunk, kCacheLineSize, [&](size_t begin, size_t end) {
+        Vector2D normal;
+        float penetration;
+        for (size_t k = begin; k < end; ++k) {
+            touching[k] = computeContact(bodies, candidates[k].a, candidates[k].b, normal, penetration);
+        }
+    });
+
+    contacts.clear();
+    for (size_t k = 0; k < candidates.size(); ++k) {
+        if (touching[k]) contacts.push_back(candidates[k]);
+    }
+}
+
+void ContactSolver::buildBatches(const BodyStorage& bodies) {
+    usedColors.assign(bodies.size(), 0);
+    contactColor.resize(contacts.size());
+
+    // Lowest colour not yet used by either dynamic body
+    size_t colorCount[kMaxColors + 1] = {};
+    for (size_t k = 0; k < contacts.size(); ++k) {
+        std::uint32_t a = contacts[k].a;
+        std::uint32_t b = contacts[k].b;
+        bool dynamicA = bodies.invMass[a] != 0.0f;
+        bool dynamicB = bodies.invMass[b] != 0.0f;
+
+        std::uint64_t used = (dynamicA ? usedColors[a] : 0) | (dynamicB ? usedColors[b] : 0);
+        std::uint8_t color = kOverflowColor;
+        if (used != ~std::uint64_t(0)) {
+            std::uint64_t freeBits = ~used;
+            color = 0;
+            while (!(freeBits & 1)) {
+                freeBits >>= 1;
+                ++color;
+            }
+            std::uint64_t bit = std::uint64_t(1) << color;
+            if (dynamicA) usedColors[a] |= bit;
+            if (dynamicB) usedColors[b] |= bit;
+        }
+        contactColor[k] = color;
+        ++colorCount[color];
+    }
+
+    hasOverflowBatch = colorCount[kOverflowColor] > 0;
+
+    // Counting sort by colour, dropping empty colours
+    batchStart.clear();
+    batchStart.push_back(0);
+    std::uint32_t colorOffset[kMaxColors + 1];
+    for (size_t c = 0; c <= kMaxColors; ++c) {
+        colorOffset[c] = batchStart.back();
+        if (colorCount[c] > 0) {
+            batchStart.push_back(batchStart.back() + static_cast<std::uint32_t>(colorCount[c]));
+        }
+    }
+    batched.resize(contacts.size());
+    for (size_t k = 0; k < contacts.size(); ++k) {
+        batched[colorOffset[contactColor[k]]++] = contacts[k];
+    }
+}
+
+void ContactSolver::solveSerial(BodyStorage& bodies) const {
+    for (const BodyPair& contact : contacts) {
+        collidePair(bodies, contact.a, contact.b);
+    }
+}
+
+void ContactSolver::solveBatches(BodyStorage& bodies, ThreadPool& pool) const {
+    for (size_t batch = 0; batch + 1 < batchStart.size(); ++batch) {
+        const BodyPair* first = batched.data() + batchStart[batch];
+        size_t count = batchStart[batch + 1] - batchStart[batch];
+
+        // The overflow batch (if any) is last and may repeat bodies
+        bool overflow = hasOverflowBatch && batch + 2 == batchStart.size();
+        if (overflow) {
+            for (size_t k = 0; k < count; ++k) {
+                collidePair(bodies, first[k].a, first[k].b);
+            }
+            continue;
+        }
+
+        pool.parallelFor(count, kMinContactsPerChunk, 1, [&](size_t begin, size_t end) {
+            for (size_t k = begin; k < end; ++k) {
+                collidePair(bodies, first[k].a, first[k].b);
+            }
+        });
+    }
+}
+
+} // namespace Physica
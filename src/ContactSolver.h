@@ -0,0 +1,55 @@
+#pragma once
+#include "BodyStorage.h"
+#include "Broadphase.h"
+#include "ThreadPool.h"
+#include <vector>
+#include <cstdint>
+
+namespace Physica {
+
+// Resolves the contacts of one step, optionally across threads.
+// Contacts are greedily coloured so that no dynamic body appears twice in
+// a colour; every colour batch is then resolved in parallel, one batch
+// after another. Static bodies are never written, so they do not constrain
+// the colouring. Because contacts inside a batch are independent, the
+// result equals resolving the batches in order on a single thread.
+class ContactSolver {
+public:
+    // Contacts needed before colouring and parallel batches pay off
+    size_t minParallelContacts = 4096;
+
+    // Runs the whole pipeline: narrowphase, colouring and resolution
+    void solve(BodyStorage& bodies, const std::vector<BodyPair>& candidates, ThreadPool& pool);
+
+    // Keeps the candidate pairs that currently overlap
+    void findContacts(const BodyStorage& bodies, const std::vector<BodyPair>& candidates, ThreadPool& pool);
+
+    // Resolves the contacts found by findContacts: serially for small sets,
+    // otherwise in colour batches across the pool. The order differs, so
+    // the choice depends on the contact count alone, never on the pool:
+    // results do not change with the thread count.
+    void resolve(BodyStorage& bodies, ThreadPool& pool);
+
+    // Greedy graph colouring of the current contacts into batches
+    void buildBatches(const BodyStorage& bodies);
+
+    // Resolves contacts in the order they were found, on the calling thread
+    void solveSerial(BodyStorage& bodies) const;
+
+    // Resolves colour batches in order, each batch across the pool
+    void solveBatches(BodyStorage& bodies, ThreadPool& pool) const;
+
+    const std::vector<BodyPair>& getContacts() const { return contacts; }
+    size_t getBatchCount() const { return batchStart.empty() ? 0 : batchStart.size() - 1; }
+
+private:
+    std::vector<BodyPair> contacts;
+    std::vector<std::uint8_t> touching;     // Narrowphase result per candidate
+    std::vector<std::uint64_t> usedColors;  // Colour bitmask per body
+    std::vector<std::uint8_t> contactColor; // Colour per contact
+    std::vector<BodyPair> batched;          // Contacts sorted by colour
+    std::vector<std::uint32_t> batchStart;  // Prefix sums, size batches + 1
+    bool hasOverflowBatch = false;
+};
+
+} // namespace Physica
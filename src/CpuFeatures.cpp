@@ -0,0 +1,79 @@
+#include "CpuFeatures.h"
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define PHYSICA_X86 1
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+namespace Physica {
+
+namespace {
+
+#ifdef PHYSICA_X86
+
+void cpuid(unsigned leaf, unsigned subleaf, unsigned regs[4]) {
+#if defined(_MSC_VER)
+    int out[4];
+    __cpuidex(out, static_cast<int>(leaf), static_cast<int>(subleaf));
+    for (int i = 0; i < 4; ++i) regs[i] = static_cast<unsigned>(out[i]);
+#else
+    __cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+}
+
+// Which register states the OS saves on context switch
+std::uint64_t readXcr0() {
+#if defined(_MSC_VER)
+    return _xgetbv(0);
+#else
+    unsigned eax, edx;
+    __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return (static_cast<std::uint64_t>(edx) << 32) | eax;
+#endif
+}
+
+CpuFeatures detect() {
+    CpuFeatures features;
+    unsigned regs[4];
+
+    cpuid(0, 0, regs);
+    unsigned maxLeaf = regs[0];
+    if (maxLeaf < 1) return features;
+
+    cpuid(1, 0, regs);
+    features.sse2 = (regs[3] >> 26) & 1;
+    bool osxsave = (regs[2] >> 27) & 1;
+    bool avx = (regs[2] >> 28) & 1;
+    if (!osxsave || !avx || maxLeaf < 7) return features;
+
+    std::uint64_t xcr0 = readXcr0();
+    bool ymmState = (xcr0 & 0x6) == 0x6;
+    bool zmmState = (xcr0 & 0xE6) == 0xE6;
+
+    cpuid(7, 0, regs);
+    features.avx2 = ymmState && ((regs[1] >> 5) & 1);
+    features.avx512f = zmmState && ((regs[1] >> 16) & 1);
+    return features;
+}
+
+#else
+
+CpuFeatures detect() {
+    return CpuFeatures();
+}
+
+#endif
+
+} // namespace
+
+const CpuFeatures& getCpuFeatures() {
+    static const CpuFeatures features = detect();
+    return features;
+}
+
+} // namespace Physica
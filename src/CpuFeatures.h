@@ -0,0 +1,15 @@
+#pragma once
+
+namespace Physica {
+
+// Instruction sets usable on this machine (CPU and OS support both checked)
+struct CpuFeatures {
+    bool sse2 = false;
+    bool avx2 = false;
+    bool avx512f = false;
+};
+
+// Detected once via CPUID on first call
+const CpuFeatures& getCpuFeatures();
+
+} // namespace Physica
@@ -0,0 +1,93 @@
+#include "EnergyGraph.h"
+#include <algorithm>
+
+namespace Physica {
+
+namespace {
+
+const sf::Color kSeriesColors[3] = {sf::Color::Green, sf::Color::Red, sf::Color::White};
+
+} // namespace
+
+EnergyGraph::EnergyGraph(size_t window)
+    : window(std::max<size_t>(window, 1)) {
+    setLevel(0);
+}
+
+void EnergyGraph::setLevel(size_t newLevel) {
+    level = std::min(newLevel, EnergyHistory::kLevels - 1);
+    synced = 0;
+    // Lines need one vertex per bucket, min/max columns two; each ring is
+    // doubled
+    size_t verticesPerBucket = level == 0 ? 1 : 2;
+    for (std::vector<sf::Vertex>& vertices : series) {
+        vertices.assign(2 * window * verticesPerBucket, sf::Vertex());
+    }
+}
+
+void EnergyGraph::sync(const EnergyHistory& history) {
+    std::uint64_t pushed = history.getPushed(level);
+    if (history.getGeneration() != generation) {
+        generation = history.getGeneration();
+        synced = 0;
+    }
+    // Only the newest window is ever shown, so older backlog is skipped
+    std::uint64_t first = std::max(synced, pushed > window ? pushed - window : 0);
+    for (std::uint64_t sequence = first; sequence < pushed; ++sequence) {
+        write(history.get(level, sequence), sequence);
+    }
+    synced = pushed;
+}
+
+void EnergyGraph::write(const EnergyRange& bucket, std::uint64_t sequence) {
+    const size_t slot = static_cast<size_t>(sequence % window);
+    const float low[3] = {bucket.min.kinetic, bucket.min.potential, bucket.min.total};
+    const float high[3] = {bucket.max.kinetic, bucket.max.potential, bucket.max.total};
+
+    for (int s = 0; s < 3; ++s) {
+        std::vector<sf::Vertex>& vertices = series[s];
+        // x is the slot, so each contiguous slice runs left to right
+        for (size_t copy = slot; copy < 2 * window; copy += window) {
+            float x = static_cast<float>(copy);
+            if (level == 0) {
+                vertices[copy] = sf::Vertex{{x, high[s]}, kSeriesColors[s]};
+            } else {
+                vertices[2 * copy] = sf::Vertex{{x, high[s]}, kSeriesColors[s]};
+                vertices[2 * copy + 1] = sf::Vertex{{x, low[s]}, kSeriesColors[s]};
+            }
+        }
+    }
+}
+
+void EnergyGraph::draw(sf::RenderTarget& target, const EnergyHistory& history, const sf::FloatRect& area) {
+    // Background
+    sf::RectangleShape background(area.size);
+    background.setPosition(area.position);
+    background.setFillColor(sf::Color(0, 0, 0, 150));
+    target.draw(background);
+
+    sync(history);
+    std::uint64_t pushed = history.getPushed(level);
+    size_t count = static_cast<size_t>(std::min<std::uint64_t>(pushed, window));
+    if (count < 2) return;
+
+    // Scale over the shown buckets, always including zero
+    float lowest = std::min(0.0f, history.getWindowMin(level));
+    float highest = std::max(1.0f, history.getWindowMax(level));
+    size_t start = static_cast<size_t>((pushed - count) % window);
+
+    sf::RenderStates states;
+    states.transform.translate({area.position.x, area.position.y + area.size.y});
+    states.transform.scale({area.size.x / window, -area.size.y / (highest - lowest)});
+    states.transform.translate({-static_cast<float>(start), -lowest});
+
+    for (const std::vector<sf::Vertex>& vertices : series) {
+        if (level == 0) {
+            target.draw(&vertices[start], count, sf::PrimitiveType::LineStrip, states);
+        } else {
+            target.draw(&vertices[2 * start], 2 * count, sf::PrimitiveType::LineStrip, states);
+        }
+    }
+}
+
+} // namespace Physica
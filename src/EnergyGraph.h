@@ -0,0 +1,39 @@
+#pragma once
+#include "EnergyHistory.h"
+#include <SFML/Graphics.hpp>
+#include <cstdint>
+#include <vector>
+
+namespace Physica {
+
+// Kinetic, potential and total energy plotted from one level of an
+// EnergyHistory. Vertices are kept in raw units across frames and only the
+// buckets pushed since the last frame are written; a transform maps them
+// into the graph area. Each series is a ring written twice (slots p and
+// p + window), so the newest `window` buckets are always one contiguous
+// slice. Level 0 draws one point per sample; higher levels draw each
+// bucket as a vertical stroke from its max to its min, so spikes that
+// decimation would average away stay visible.
+class EnergyGraph {
+public:
+    explicit EnergyGraph(size_t window);
+
+    // History level shown: 0 is one point per sample, each step up covers
+    // EnergyHistory::kDecimation times more time
+    void setLevel(size_t level);
+    size_t getLevel() const { return level; }
+
+    void draw(sf::RenderTarget& target, const EnergyHistory& history, const sf::FloatRect& area);
+
+private:
+    size_t window;
+    size_t level = 0;
+    std::uint64_t synced = 0;  // Buckets of the level already written
+    std::uint64_t generation = 0;
+    std::vector<sf::Vertex> series[3];  // Kinetic, potential, total
+
+    void sync(const EnergyHistory& history);
+    void write(const EnergyRange& bucket, std::uint64_t sequence);
+};
+
+} // namespace Physica
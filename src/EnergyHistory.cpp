@@ -0,0 +1,99 @@
+#include "EnergyHistory.h"
+#include <algorithm>
+
+namespace Physica {
+
+namespace {
+
+float lowestOf(const EnergyData& data) {
+    return std::min(data.total, std::min(data.kinetic, data.potential));
+}
+
+float highestOf(const EnergyData& data) {
+    return std::max(data.total, std::max(data.kinetic, data.potential));
+}
+
+void merge(EnergyRange& into, const EnergyRange& bucket) {
+    into.min.kinetic = std::min(into.min.kinetic, bucket.min.kinetic);
+    into.min.potential = std::min(into.min.potential, bucket.min.potential);
+    into.min.total = std::min(into.min.total, bucket.min.total);
+    into.max.kinetic = std::max(into.max.kinetic, bucket.max.kinetic);
+    into.max.potential = std::max(into.max.potential, bucket.max.potential);
+    into.max.total = std::max(into.max.total, bucket.max.total);
+    into.max.time = bucket.max.time;
+}
+
+} // namespace
+
+void EnergyHistory::MonotonicQueue::reset(size_t window) {
+    ring.assign(window + 1, Entry{0, 0.0f});
+    head = 0;
+    count = 0;
+}
+
+template <typename Better>
+void EnergyHistory::MonotonicQueue::push(std::uint64_t sequence, float value, size_t window, Better better) {
+    const size_t slots = ring.size();
+    // Entries no better than the new one can never be the extreme again
+    while (count > 0 && !better(ring[(head + count - 1) % slots].value, value)) {
+        --count;
+    }
+    ring[(head + count) % slots] = Entry{sequence, value};
+    ++count;
+    // Drop the front once it slides out of the window
+    while (ring[head].sequence + window <= sequence) {
+        head = (head + 1) % slots;
+        --count;
+    }
+}
+
+EnergyHistory::EnergyHistory(size_t capacity, size_t window)
+    : capacity(std::max(capacity, window)), window(std::max<size_t>(window, 1)) {
+    clear();
+}
+
+void EnergyHistory::push(const EnergyData& sample) {
+    pushBucket(0, EnergyRange{sample, sample});
+}
+
+void EnergyHistory::clear() {
+    ++generation;
+    for (Level& level : levels) {
+        level.ring.resize(capacity);
+        level.pushed = 0;
+        level.pendingCount = 0;
+        level.lowest.reset(window);
+        level.highest.reset(window);
+    }
+}
+
+float EnergyHistory::getWindowMin(size_t level) const {
+    const MonotonicQueue& queue = levels[level].lowest;
+    return queue.count > 0 ? queue.front().value : 0.0f;
+}
+
+float EnergyHistory::getWindowMax(size_t level) const {
+    const MonotonicQueue& queue = levels[level].highest;
+    return queue.count > 0 ? queue.front().value : 0.0f;
+}
+
+void EnergyHistory::pushBucket(size_t index, const EnergyRange& bucket) {
+    Level& level = levels[index];
+    std::uint64_t sequence = level.pushed++;
+    level.ring[sequence % capacity] = bucket;
+    level.lowest.push(sequence, lowestOf(bucket.min), window, [](float a, float b) { return a < b; });
+    level.highest.push(sequence, highestOf(bucket.max), window, [](float a, float b) { return a > b; });
+
+    if (index + 1 == kLevels) return;
+    if (level.pendingCount == 0) {
+        level.pending = bucket;
+    } else {
+        merge(level.pending, bucket);
+    }
+    if (++level.pendingCount == kDecimation) {
+        level.pendingCount = 0;
+        pushBucket(index + 1, level.pending);
+    }
+}
+
+} // namespace Physica
@@ -0,0 +1,92 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Physica {
+
+struct EnergyData {
+    float time;
+    float kinetic;
+    float potential;
+    float total;
+};
+
+// Lowest and highest value of each series over a run of samples. `min.time`
+// is the time of the first sample and `max.time` of the last.
+struct EnergyRange {
+    EnergyData min;
+    EnergyData max;
+};
+
+// Energy samples over an unbounded run in fixed memory.
+// Level 0 keeps the newest `capacity` samples in a ring. Every
+// kDecimation buckets of a level are merged into one min/max bucket of the
+// next level, so level k spans kDecimation^k times as much time in the same
+// ring size. Each level also tracks the extremes of its newest `window`
+// buckets with monotonic queues, so a graph of those buckets can be scaled
+// without scanning them. push is O(1) amortized.
+class EnergyHistory {
+public:
+    static constexpr size_t kLevels = 8;
+    static constexpr size_t kDecimation = 4;
+
+    // `window` buckets per level are tracked for min/max; capacity >= window
+    explicit EnergyHistory(size_t capacity = 1024, size_t window = 300);
+
+    void push(const EnergyData& sample);
+    void clear();
+
+    // Bumped by every clear, so readers can tell their copy is stale
+    std::uint64_t getGeneration() const { return generation; }
+    size_t getCapacity() const { return capacity; }
+    size_t getWindow() const { return window; }
+
+    // Buckets pushed to a level since the last clear. Sequence numbers
+    // [pushed - min(pushed, capacity), pushed) can be read back.
+    std::uint64_t getPushed(size_t level) const { return levels[level].pushed; }
+    const EnergyRange& get(size_t level, std::uint64_t sequence) const {
+        return levels[level].ring[sequence % capacity];
+    }
+
+    // Lowest and highest value of any series over the newest `window`
+    // buckets of a level (0 when the level is empty)
+    float getWindowMin(size_t level) const;
+    float getWindowMax(size_t level) const;
+
+private:
+    // Sliding window extreme: keeps the candidates in order of arrival with
+    // values strictly improving towards the front, which holds the extreme
+    struct MonotonicQueue {
+        struct Entry {
+            std::uint64_t sequence;
+            float value;
+        };
+        std::vector<Entry> ring;  // window + 1 slots
+        size_t head = 0;
+        size_t count = 0;
+
+        void reset(size_t window);
+        template <typename Better>
+        void push(std::uint64_t sequence, float value, size_t window, Better better);
+        const Entry& front() const { return ring[head]; }
+    };
+
+    struct Level {
+        std::vector<EnergyRange> ring;
+        std::uint64_t pushed = 0;
+        EnergyRange pending;      // Partial bucket for the next level
+        size_t pendingCount = 0;
+        MonotonicQueue lowest;
+        MonotonicQueue highest;
+    };
+
+    size_t capacity;
+    size_t window;
+    std::uint64_t generation = 0;
+    Level levels[kLevels];
+
+    void pushBucket(size_t level, const EnergyRange& bucket);
+};
+
+} // namespace Physica
@@ -0,0 +1,169 @@
+#pragma once
+#include "SimdKernels.h"
+#include "Vector2D.h"
+#include <cmath>
+#include <cstddef>
+#include <tuple>
+#include <vector>
+
+namespace Physica {
+
+// User force fields. Each field type is a generator: force(position, mass)
+// returns the force it applies to a body there, and potential(position,
+// mass) the potential energy of a body there (zero for fields with no
+// potential). Fields act on dynamic bodies only.
+
+// Same acceleration everywhere (wind, a tilted table, a charged plate)
+struct UniformField {
+    Vector2D acceleration;
+
+    Vector2D force(const Vector2D&, float mass) const {
+        return acceleration * mass;
+    }
+
+    float potential(const Vector2D& position, float mass) const {
+        return -mass * acceleration.dot(position);
+    }
+};
+
+// Pulls bodies towards the center (negative strength pushes them away).
+// The acceleration is `strength` at the center and falls off linearly to
+// zero at `radius`.
+struct RadialField {
+    Vector2D center;
+    float strength = 0.0f;
+    float radius = 0.0f;
+
+    Vector2D force(const Vector2D& position, float mass) const {
+        Vector2D offset = center - position;
+        float distanceSquared = offset.x * offset.x + offset.y * offset.y;
+        if (distanceSquared >= radius * radius || distanceSquared < 0.0001f) {
+            return Vector2D(0, 0);
+        }
+        float distance = std::sqrt(distanceSquared);
+        float falloff = 1.0f - distance / radius;
+        return offset * (strength * falloff * mass / distance);
+    }
+
+    // Zero at `radius` and beyond
+    float potential(const Vector2D& position, float mass) const {
+        float distance = (center - position).magnitude();
+        if (distance >= radius) return 0.0f;
+        float fromEdge = radius - distance;
+        return -mass * strength * fromEdge * fromEdge / (2.0f * radius);
+    }
+};
+
+// Swirls bodies around the center, counter-clockwise on screen for positive
+// strength. Same linear falloff as RadialField.
+struct VortexField {
+    Vector2D center;
+    float strength = 0.0f;
+    float radius = 0.0f;
+
+    Vector2D force(const Vector2D& position, float mass) const {
+        Vector2D offset = position - center;
+        float distanceSquared = offset.x * offset.x + offset.y * offset.y;
+        if (distanceSquared >= radius * radius || distanceSquared < 0.0001f) {
+            return Vector2D(0, 0);
+        }
+        float distance = std::sqrt(distanceSquared);
+        float falloff = 1.0f - distance / radius;
+        Vector2D tangent(offset.y, -offset.x);
+        return tangent * (strength * falloff * mass / distance);
+    }
+
+    // A swirl does work around every loop, so it has no potential
+    float potential(const Vector2D&, float) const {
+        return 0.0f;
+    }
+};
+
+// Pulls bodies towards the anchor in proportion to their distance, like a
+// spring of stiffness `stiffness * mass`: a body oscillates about it with
+// angular frequency sqrt(stiffness), whatever its mass.
+struct SpringField {
+    Vector2D anchor;
+    float stiffness = 0.0f;  // Acceleration per pixel of stretch, 1/s^2
+
+    Vector2D force(const Vector2D& position, float mass) const {
+        return (anchor - position) * (stiffness * mass);
+    }
+
+    float potential(const Vector2D& position, float mass) const {
+        return 0.5f * mass * stiffness * (position - anchor).magnitudeSquared();
+    }
+};
+
+// Registered fields of every type in Fields..., applied to a batch in one
+// loop. The field types are fixed at compile time, so the per-body loop
+// calls each field's force() directly (no virtual calls) and reads and
+// writes each body's state once however many fields are registered.
+template <typename... Fields>
+class ForcePipeline {
+public:
+    template <typename Field>
+    void add(const Field& field) {
+        std::get<std::vector<Field>>(fields).push_back(field);
+    }
+
+    template <typename Field>
+    const std::vector<Field>& get() const {
+        return std::get<std::vector<Field>>(fields);
+    }
+
+    void clear() {
+        std::apply([](auto&... list) { (list.clear(), ...); }, fields);
+    }
+
+    bool empty() const {
+        return std::apply([](const auto&... list) { return (list.empty() && ...); }, fields);
+    }
+
+    // Adds every field's force to each dynamic body in the batch
+    void accumulate(const BodyBatch& batch) const {
+        for (size_t i = 0; i < batch.count; ++i) {
+            if (batch.invMass[i] == 0.0f) continue;
+            batch.force[i] = force(batch.position[i], batch.mass[i], batch.force[i]);
+        }
+    }
+
+    // `total` plus every field's force on a body at `position`
+    Vector2D force(const Vector2D& position, float mass, Vector2D total = Vector2D(0, 0)) const {
+        std::apply([&](const auto&... list) {
+            (addForces(list, position, mass, total), ...);
+        }, fields);
+        return total;
+    }
+
+    // Sum of every field's potential energy for a body at `position`
+    float potential(const Vector2D& position, float mass) const {
+        float total = 0.0f;
+        std::apply([&](const auto&... list) {
+            (addPotentials(list, position, mass, total), ...);
+        }, fields);
+        return total;
+    }
+
+private:
+    std::tuple<std::vector<Fields>...> fields;
+
+    template <typename Field>
+    static void addForces(const std::vector<Field>& list, const Vector2D& position, float mass, Vector2D& total) {
+        for (const Field& field : list) {
+            total += field.force(position, mass);
+        }
+    }
+
+    template <typename Field>
+    static void addPotentials(const std::vector<Field>& list, const Vector2D& position, float mass, float& total) {
+        for (const Field& field : list) {
+            total += field.potential(position, mass);
+        }
+    }
+};
+
+// Field types the engine supports; add a new generator type here
+using ForceFieldPipeline = ForcePipeline<UniformField, RadialField, VortexField, SpringField>;
+
+} // namespace Physica
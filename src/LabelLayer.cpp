@@ -0,0 +1,102 @@
+#include "LabelLayer.h"
+#include <cstdint>
+
+namespace Physica {
+
+namespace {
+
+// Frames a string may go unused before its layout is dropped
+constexpr unsigned kEvictAfterFrames = 120;
+
+} // namespace
+
+LabelLayer::LabelLayer(const sf::Font& font, unsigned characterSize)
+    : font(font), characterSize(characterSize), vertices(sf::PrimitiveType::Triangles) {
+}
+
+void LabelLayer::begin() {
+    vertices.clear();
+    ++frame;
+    
+    if (frame % kEvictAfterFrames == 0) {
+        for (auto it = cache.begin(); it != cache.end();) {
+            if (frame - it->second.lastUsedFrame > kEvictAfterFrames) {
+                it = cache.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+}
+
+void LabelLayer::add(const std::string& text, sf::Vector2f position, sf::Color color) {
+    auto found = cache.find(text);
+    if (found == cache.end()) {
+        found = cache.emplace(text, CachedLabel()).first;
+        layout(text, found->second.vertices);
+    }
+    CachedLabel& label = found->second;
+    label.lastUsedFrame = frame;
+    
+    for (const sf::Vertex& glyphVertex : label.vertices) {
+        vertices.append(sf::Vertex{glyphVertex.position + position, color, glyphVertex.texCoords});
+    }
+}
+
+void LabelLayer::draw(sf::RenderTarget& target) {
+    if (vertices.getVertexCount() == 0) return;
+    
+    // Fetched per draw: the font grows its texture as new glyphs are laid out
+    target.draw(vertices, sf::RenderStates(&font.getTexture(characterSize)));
+}
+
+void LabelLayer::layout(const std::string& text, std::vector<sf::Vertex>& out) const {
+    // Same metrics as sf::Text: the first baseline sits one character size
+    // below the origin, and glyph rectangles carry one texel of padding
+    const float padding = 1.0f;
+    const float lineSpacing = font.getLineSpacing(characterSize);
+    float x = 0.0f;
+    float y = static_cast<float>(characterSize);
+    char32_t previous = 0;
+    
+    out.clear();
+    for (unsigned char byte : text) {
+        char32_t character = byte;
+        x += font.getKerning(previous, character, characterSize);
+        previous = character;
+        
+        if (character == '\n') {
+            x = 0.0f;
+            y += lineSpacing;
+            continue;
+        }
+        
+        const sf::Glyph& glyph = font.getGlyph(character, characterSize, false);
+        float left = x + glyph.bounds.position.x - padding;
+        float top = y + glyph.bounds.position.y - padding;
+        float right = x + glyph.bounds.position.x + glyph.bounds.size.x + padding;
+        float bottom = y + glyph.bounds.position.y + glyph.bounds.size.y + padding;
+        
+        float u1 = static_cast<float>(glyph.textureRect.position.x) - padding;
+        float v1 = static_cast<float>(glyph.textureRect.position.y) - padding;
+        float u2 = static_cast<float>(glyph.textureRect.position.x + glyph.textureRect.size.x) + padding;
+        float v2 = static_cast<float>(glyph.textureRect.position.y + glyph.textureRect.size.y) + padding;
+        
+        const sf::Vertex corners[4] = {
+            {{left, top}, sf::Color::White, {u1, v1}},
+            {{right, top}, sf::Color::White, {u2, v1}},
+            {{right, bottom}, sf::Color::White, {u2, v2}},
+            {{left, bottom}, sf::Color::White, {u1, v2}},
+        };
+        out.push_back(corners[0]);
+        out.push_back(corners[1]);
+        out.push_back(corners[2]);
+        out.push_back(corners[0]);
+        out.push_back(corners[2]);
+        out.push_back(corners[3]);
+        
+        x += glyph.advance;
+    }
+}
+
+} // namespace Physica
@@ -0,0 +1,44 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Physica {
+
+// Text labels drawn as one vertex batch against the font texture.
+// Each distinct string is laid out once into glyph quads relative to its
+// origin and cached; drawing a label again only translates those quads to
+// its new position. Strings unused for a while are evicted, so labels that
+// change every frame do not grow the cache forever.
+class LabelLayer {
+public:
+    LabelLayer(const sf::Font& font, unsigned characterSize);
+
+    // Starts a new frame of labels
+    void begin();
+
+    // Queues a label with its top-left corner at `position`
+    void add(const std::string& text, sf::Vector2f position, sf::Color color);
+
+    // Draws every queued label in one call
+    void draw(sf::RenderTarget& target);
+
+    size_t getCachedCount() const { return cache.size(); }
+
+private:
+    struct CachedLabel {
+        std::vector<sf::Vertex> vertices;  // Glyph triangles, origin at (0, 0)
+        unsigned lastUsedFrame = 0;
+    };
+
+    const sf::Font& font;
+    unsigned characterSize;
+    unsigned frame = 0;
+    std::unordered_map<std::string, CachedLabel> cache;
+    sf::VertexArray vertices;
+
+    void layout(const std::string& text, std::vector<sf::Vertex>& out) const;
+};
+
+} // namespace Physica
@@ -1,221 +1,646 @@
 #include "PhysicsEngine.h"
+#include "Collision.h"
+#include "StagedIntegrators.h"
 #include <cmath>
 #include <algorithm>
+#include <chrono>
+#include <cstring>
 
 namespace Physica {
 
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double elapsedNs(Clock::time_point start, Clock::time_point end) {
+    return std::chrono::duration<double, std::nano>(end - start).count();
+}
+
+// Below this many bodies per chunk, waking workers costs more than the work
+constexpr size_t kMinBodiesPerChunk = 2048;
+
+// Bodies per fused force and integration tile (about 10 KB of state)
+constexpr size_t kBodiesPerTile = 256;
+
+// Longest continuous collision paths are searched in at most this many pieces
+constexpr float kMaxSweepPieces = 64.0f;
+
+// The corner of the bounds on the side gravity pulls towards, where the
+// height in m g h is zero
+Vector2D gravityFloor(const Vector2D& gravity, const Vector2D& bounds) {
+    return Vector2D(gravity.x > 0.0f ? bounds.x : 0.0f, gravity.y > 0.0f ? bounds.y : 0.0f);
+}
+
+} // namespace
+
 PhysicsEngine::PhysicsEngine()
     : gravity(0, 980.0f), // 980 pixels/s^2 (simulating 9.8 m/s^2)
-      integrationMethod(IntegrationMethod::SemiImplicitEuler) {
+      bounds(1280.0f, 720.0f),
+      integrationMethod(IntegrationMethod::SemiImplicitEuler),
+      broadphaseMethod(BroadphaseMethod::UniformGrid),
+      gravityMode(GravityMode::Uniform) {
 }
 
 void PhysicsEngine::update(float dt) {
-    // Apply forces
-    if (gravityEnabled) {
-        applyGravity();
+    if (integrationMethod == IntegrationMethod::Xpbd) {
+        advanceSubsteps(dt, false, true);
+    } else {
+        advance(dt, false, true);
+    }
+}
+
+void PhysicsEngine::step(size_t count, float dt, std::vector<StepSample>* samples, size_t sampleEvery) {
+    for (size_t i = 0; i < count; ++i) {
+        const bool sampled = samples && sampleEvery > 0 && (stepCount + 1) % sampleEvery == 0;
+        if (integrationMethod == IntegrationMethod::Xpbd) {
+            advanceSubsteps(dt, boundaryEnabled, sampled || i + 1 == count);
+        } else {
+            advance(dt, i > 0 && boundaryEnabled, sampled || i + 1 == count);
+        }
+        if (sampled) {
+            samples->push_back({stepCount, energyStats});
+        }
+    }
+    if (count > 0 && integrationMethod != IntegrationMethod::Xpbd) {
+        handleBoundaryCollisions(bounds.x, bounds.y);
     }
+}
+
+void PhysicsEngine::advance(float dt, bool wallsFirst, bool measure) {
+    const KernelTable& kernels = simdEnabled ? getBestKernels() : getScalarKernels();
     
-    applyFriction();
-    applyAirResistance(airResistanceCoefficient);
+    ForceParams forces;
+    forces.gravity = gravity;
+    forces.airResistance = airResistanceCoefficient;
     
-    // Integrate physics
-    for (auto& obj : objects) {
-        if (!obj->isStatic) {
-            // Calculate acceleration from forces
-            obj->acceleration = obj->forceAccumulator * obj->getInverseMass();
-            
-            // Integrate based on selected method
-            switch (integrationMethod) {
-                case IntegrationMethod::Euler:
-                    integrateEuler(*obj, dt);
-                    break;
-                case IntegrationMethod::SemiImplicitEuler:
-                    integrateSemiImplicitEuler(*obj, dt);
-                    break;
-                case IntegrationMethod::Verlet:
-                    integrateVerlet(*obj, dt);
-                    break;
+    // One kernel compiled for this integrator and force set, picked once;
+    // the staged integrators evaluate forces, fields included, themselves
+    const bool uniformGravity = gravityEnabled && gravityMode == GravityMode::Uniform;
+    const bool drag = airResistanceCoefficient > 0.0f;
+    const bool staged = isStagedMethod(integrationMethod);
+    StepKernel stepKernel = kernels.select(integrationMethod, uniformGravity, drag);
+    
+    // Fields go first, into each tile's force accumulator, while the tile
+    // is in L1; the step kernel then adds the built-in forces and
+    // integrates in one pass
+    const bool hasFields = !forceFields.empty();
+    auto start = Clock::now();
+    if (gravityEnabled && gravityMode == GravityMode::Mutual) {
+        // The tree reads every position, so the walls cannot wait
+        if (wallsFirst) {
+            handleBoundaryCollisions(bounds.x, bounds.y);
+            wallsFirst = false;
+        }
+        mutualGravity.apply(bodies, threadPool);
+    }
+    // Chunks are whole tiles, so every tile has a fixed slot for its
+    // energy sums, which read the tile while the step has it in L1
+    const size_t tileCount = (bodies.size() + kBodiesPerTile - 1) / kBodiesPerTile;
+    if (measure) {
+        tileMoments.resize(tileCount);
+    }
+    // Fast bodies are spotted per tile by comparing against a copy of the
+    // tile's start positions
+    const bool sweep = collisionsEnabled && continuousCollisionEnabled;
+    if (sweep) {
+        tileSweeps.resize(tileCount);
+    }
+    threadPool.parallelFor(bodies.size(), kMinBodiesPerChunk, kBodiesPerTile, [&](size_t begin, size_t end) {
+        Vector2D tileStart[kBodiesPerTile];
+        for (size_t tile = begin; tile < end; tile += kBodiesPerTile) {
+            size_t tileEnd = std::min(end, tile + kBodiesPerTile);
+            if (wallsFirst) {
+                applyBoundary(tile, tileEnd, bounds.x, bounds.y);
+            }
+            BodyBatch batch = makeBatch(tile, tileEnd);
+            if (sweep) {
+                std::copy(batch.position, batch.position + batch.count, tileStart);
+            }
+            if (staged) {
+                stepStaged(integrationMethod, batch, forces, uniformGravity, drag, forceFields, dt);
+            } else {
+                if (hasFields) {
+                    forceFields.accumulate(batch);
+                }
+                stepKernel(batch, forces, dt);
+            }
+            if (sweep) {
+                findSweeps(tile, tileEnd, tileStart, tileSweeps[tile / kBodiesPerTile]);
+            }
+            if (measure) {
+                measureTile(batch, tile, kernels.measure, tileMoments[tile / kBodiesPerTile]);
             }
-            
-            obj->clearForces();
         }
+    });
+    if (measure) {
+        combineTileMoments();
     }
+    lastStepTimings = StepTimings();
+    lastStepTimings.integrate = elapsedNs(start, Clock::now());
     
-    // Handle collisions
+    // Handle collisions, fast bodies first so the discrete pass sees them
+    // at their time of impact
+    if (sweep) {
+        auto sweepStart = Clock::now();
+        sweepFastBodies(dt);
+        lastStepTimings.sweep = elapsedNs(sweepStart, Clock::now());
+    }
     if (collisionsEnabled) {
         handleCollisions();
     }
+    
+    updateSleep(dt, contactSolver.getContacts());
+    ++stepCount;
+}
+
+void PhysicsEngine::advanceSubsteps(float dt, bool walls, bool measure) {
+    const KernelTable& kernels = simdEnabled ? getBestKernels() : getScalarKernels();
+    
+    ForceParams forces;
+    forces.gravity = gravity;
+    forces.airResistance = airResistanceCoefficient;
+    
+    const bool uniformGravity = gravityEnabled && gravityMode == GravityMode::Uniform;
+    StepKernel stepKernel = kernels.select(IntegrationMethod::Xpbd, uniformGravity, airResistanceCoefficient > 0.0f);
+    const bool hasFields = !forceFields.empty();
+    const int substeps = std::max(xpbd.substeps, 1);
+    const float h = dt / substeps;
+    const float restingSpeed = 2.0f * (uniformGravity ? gravity.magnitude() : 0.0f) * h;
+    
+    lastStepTimings = StepTimings();
+    auto start = Clock::now();
+    if (gravityEnabled && gravityMode == GravityMode::Mutual) {
+        mutualGravity.apply(bodies, threadPool);
+    }
+    lastStepTimings.integrate = elapsedNs(start, Clock::now());
+    
+    // Pairs are found once per step: every pair close enough to touch
+    // before the step ends, widened by how far bodies can move in it
+    auto pairStart = Clock::now();
+    candidatePairs.clear();
+    float margin = 0.0f;
+    if (collisionsEnabled) {
+        margin = substepPairMargin(dt);
+        uniformGrid.margin = margin;
+        uniformGrid.findPairs(bodies, candidatePairs);
+        uniformGrid.margin = 0.0f;
+    }
+    xpbd.gatherPairs(bodies, candidatePairs, margin);
+    if (canSleep()) {
+        sleepManager.wakeTouched(bodies, xpbd.getPairs(), wakeVelocity);
+    }
+    lastStepTimings.broadphase = elapsedNs(pairStart, Clock::now());
+    
+    // Forces applied before the step (by hand or by mutual gravity) act on
+    // every substep; the kernel clears them, so they are put back each time
+    const size_t tileCount = (bodies.size() + kBodiesPerTile - 1) / kBodiesPerTile;
+    if (measure) {
+        tileMoments.resize(tileCount);
+    }
+    substepForce.resize(bodies.size());
+    for (int substep = 0; substep < substeps; ++substep) {
+        const bool last = substep + 1 == substeps;
+        auto predictStart = Clock::now();
+        threadPool.parallelFor(bodies.size(), kMinBodiesPerChunk, kBodiesPerTile, [&](size_t begin, size_t end) {
+            for (size_t tile = begin; tile < end; tile += kBodiesPerTile) {
+                BodyBatch batch = makeBatch(tile, std::min(end, tile + kBodiesPerTile));
+                Vector2D* saved = substepForce.data() + tile;
+                if (substep == 0) {
+                    std::copy(batch.force, batch.force + batch.count, saved);
+                } else {
+                    std::copy(saved, saved + batch.count, batch.force);
+                }
+                if (hasFields) {
+                    forceFields.accumulate(batch);
+                }
+                stepKernel(batch, forces, h);
+            }
+        });
+        auto solveStart = Clock::now();
+        xpbd.solveContacts(bodies, h);
+        auto finishStart = Clock::now();
+        threadPool.parallelFor(bodies.size(), kMinBodiesPerChunk, kBodiesPerTile, [&](size_t begin, size_t end) {
+            for (size_t tile = begin; tile < end; tile += kBodiesPerTile) {
+                size_t tileEnd = std::min(end, tile + kBodiesPerTile);
+                xpbd.finishBodies(bodies, tile, tileEnd, walls, bounds, h, restingSpeed);
+                if (last && measure) {
+                    measureTile(makeBatch(tile, tileEnd), tile, kernels.measure, tileMoments[tile / kBodiesPerTile]);
+                }
+            }
+        });
+        auto velocityStart = Clock::now();
+        xpbd.solveVelocities(bodies, restingSpeed);
+        auto substepEnd = Clock::now();
+        lastStepTimings.integrate += elapsedNs(predictStart, solveStart) + elapsedNs(finishStart, velocityStart);
+        lastStepTimings.contacts += elapsedNs(solveStart, finishStart) + elapsedNs(velocityStart, substepEnd);
+    }
+    if (measure) {
+        combineTileMoments();
+    }
+    
+    updateSleep(dt, xpbd.getContacts());
+    ++stepCount;
+}
+
+float PhysicsEngine::substepPairMargin(float dt) const {
+    // A pair closes at most twice as fast as the fastest body moves. The
+    // margin is capped at the largest body's diameter so a single fast
+    // body cannot blow up the grid's cells; past that, contacts are caught
+    // a step late by their overlap
+    const float pull = (gravityEnabled && gravityMode == GravityMode::Uniform ? gravity.magnitude() : 0.0f) * dt * dt;
+    float fastest = 0.0f;
+    float largest = 0.0f;
+    for (size_t i = 0; i < bodies.size(); ++i) {
+        largest = std::max(largest, bodies.boundingRadius(i));
+        if (bodies.invMass[i] == 0.0f) continue;
+        fastest = std::max(fastest, bodies.velocity[i].magnitudeSquared());
+    }
+    return std::min(2.0f * (std::sqrt(fastest) * dt + pull), 2.0f * largest);
 }
 
 void PhysicsEngine::reset() {
-    objects.clear();
+    clearObjects();
 }
 
-void PhysicsEngine::addObject(std::shared_ptr<PhysicsObject> object) {
-    objects.push_back(object);
+size_t PhysicsEngine::addObject(const PhysicsObject& object) {
+    sweepAndPrune.invalidate();
+    return bodies.add(object);
 }
 
 void PhysicsEngine::removeObject(size_t index) {
-    if (index < objects.size()) {
-        objects.erase(objects.begin() + index);
-    }
+    if (index >= bodies.size()) return;
+    // Bodies resting on the removed one must fall. Only its own island can
+    // rest on it: an awake body's neighbours would have been woken with it.
+    sleepManager.wakeBody(bodies, index);
+    sweepAndPrune.invalidate();
+    bodies.remove(index);
+}
+
+bool PhysicsEngine::removeObject(BodyHandle handle) {
+    std::optional<size_t> index = bodies.find(handle);
+    if (!index) return false;
+    removeObject(*index);
+    return true;
 }
 
 void PhysicsEngine::clearObjects() {
-    objects.clear();
+    sweepAndPrune.invalidate();
+    bodies.clear();
 }
 
-void PhysicsEngine::applyGravity() {
-    for (auto& obj : objects) {
-        if (!obj->isStatic) {
-            obj->addForce(gravity * obj->mass);
-        }
-    }
+void PhysicsEngine::resyncBodies() {
+    bodies.resetHandles();
+    sweepAndPrune.invalidate();
+    sleepManager.resync(bodies);
+    // Restored sleepers came to rest under the current gravity
+    sleepGravity = gravityEnabled ? gravity : Vector2D(0, 0);
 }
 
-void PhysicsEngine::applyFriction() {
-    for (auto& obj : objects) {
-        if (!obj->isStatic && obj->friction > 0.0f) {
-            Vector2D frictionForce = obj->velocity * (-obj->friction);
-            obj->addForce(frictionForce);
-        }
+void PhysicsEngine::setBroadphaseMethod(BroadphaseMethod method) {
+    // Incremental state may be stale after running another broadphase
+    if (method != broadphaseMethod) {
+        sweepAndPrune.invalidate();
+    }
+    // Brute force reports no contacts, so nothing could wake sleepers
+    if (method == BroadphaseMethod::BruteForce) {
+        sleepManager.wakeAll(bodies);
     }
+    broadphaseMethod = method;
 }
 
-void PhysicsEngine::applyAirResistance(float coefficient) {
-    for (auto& obj : objects) {
-        if (!obj->isStatic && coefficient > 0.0f) {
-            float speedSquared = obj->velocity.magnitudeSquared();
-            if (speedSquared > 0.0001f) {
-                Vector2D dragDirection = obj->velocity.normalized() * -1.0f;
-                Vector2D dragForce = dragDirection * (coefficient * speedSquared);
-                obj->addForce(dragForce);
-            }
-        }
+void PhysicsEngine::setGravityMode(GravityMode mode) {
+    if (mode != gravityMode) {
+        sleepManager.wakeAll(bodies);
     }
+    gravityMode = mode;
 }
 
-void PhysicsEngine::integrateEuler(PhysicsObject& obj, float dt) {
-    obj.velocity += obj.acceleration * dt;
-    obj.position += obj.velocity * dt;
+template <typename Fn>
+void PhysicsEngine::forEachBodyRange(Fn&& fn) {
+    threadPool.parallelFor(bodies.size(), kMinBodiesPerChunk, kBodiesPerCacheLine, fn);
 }
 
-void PhysicsEngine::integrateSemiImplicitEuler(PhysicsObject& obj, float dt) {
-    obj.velocity += obj.acceleration * dt;
-    obj.position += obj.velocity * dt;
+BodyBatch PhysicsEngine::makeBatch(size_t begin, size_t end) {
+    BodyBatch batch;
+    batch.position = bodies.position.data() + begin;
+    batch.velocity = bodies.velocity.data() + begin;
+    batch.force = bodies.force.data() + begin;
+    batch.previousPosition = bodies.previousPosition.data() + begin;
+    batch.invMass = bodies.invMass.data() + begin;
+    batch.mass = bodies.mass.data() + begin;
+    batch.friction = bodies.friction.data() + begin;
+    batch.count = end - begin;
+    return batch;
 }
 
-void PhysicsEngine::integrateVerlet(PhysicsObject& obj, float dt) {
-    Vector2D newPosition = obj.position * 2.0f - obj.previousPosition + obj.acceleration * (dt * dt);
-    obj.previousPosition = obj.position;
-    obj.velocity = (newPosition - obj.position) / dt;
-    obj.position = newPosition;
+void PhysicsEngine::findSweeps(size_t begin, size_t end, const Vector2D* start, std::vector<Sweep>& out) const {
+    out.clear();
+    for (size_t i = begin; i < end; ++i) {
+        if (bodies.invMass[i] == 0.0f) continue;
+        Vector2D moved = bodies.position[i] - start[i - begin];
+        float reach = ccdThreshold * bodies.boundingRadius(i);
+        if (moved.magnitudeSquared() > reach * reach || bodies.bullet[i]) {
+            out.push_back({static_cast<std::uint32_t>(i), start[i - begin]});
+        }
+    }
 }
 
-void PhysicsEngine::handleCollisions() {
-    // Check all pairs of objects
-    for (size_t i = 0; i < objects.size(); ++i) {
-        for (size_t j = i + 1; j < objects.size(); ++j) {
-            if (objects[i]->shape == ShapeType::Circle && 
-                objects[j]->shape == ShapeType::Circle) {
-                if (checkCircleCircleCollision(*objects[i], *objects[j])) {
-                    resolveCircleCircleCollision(*objects[i], *objects[j]);
-                }
-            }
+void PhysicsEngine::sweepFastBodies(float dt) {
+    // Tile order keeps the result independent of the thread count
+    bool any = false;
+    for (const std::vector<Sweep>& sweeps : tileSweeps) {
+        any = any || !sweeps.empty();
+    }
+    if (!any || bodies.size() < 2) return;
+    
+    // The discrete broadphase rebuilds the grid afterwards; sharing it
+    // keeps one set of buffers warm
+    uniformGrid.build(bodies);
+    for (const std::vector<Sweep>& sweeps : tileSweeps) {
+        for (const Sweep& sweep : sweeps) {
+            resolveSweep(sweep, dt);
         }
     }
 }
 
-void PhysicsEngine::handleBoundaryCollisions(float width, float height) {
-    if (!boundaryEnabled) return;
+void PhysicsEngine::resolveSweep(const Sweep& sweep, float dt) {
+    const std::uint32_t body = sweep.body;
+    Vector2D from = sweep.start;
+    Vector2D motion = bodies.position[body] - from;
+    float remaining = 1.0f;  // Fraction of the step left to move
     
-    for (auto& obj : objects) {
-        if (obj->isStatic) continue;
+    for (int impact = 0; impact < maxSweepImpacts; ++impact) {
+        float t = 1.0f;
+        std::uint32_t hit = findImpact(body, from, motion, t);
+        bodies.position[body] = from + motion * t;
+        if (hit == body) break;
         
-        if (obj->shape == ShapeType::Circle) {
-            // Left boundary
-            if (obj->position.x - obj->radius < 0) {
-                obj->position.x = obj->radius;
-                obj->velocity.x *= -obj->restitution;
-            }
-            // Right boundary
-            if (obj->position.x + obj->radius > width) {
-                obj->position.x = width - obj->radius;
-                obj->velocity.x *= -obj->restitution;
-            }
-            // Top boundary
-            if (obj->position.y - obj->radius < 0) {
-                obj->position.y = obj->radius;
-                obj->velocity.y *= -obj->restitution;
+        // Stop at the impact and bounce, then use the rest of the step
+        if (bodies.motion[hit] == BodyMotion::Sleeping && canSleep()) {
+            sleepManager.wakeBody(bodies, hit);
+        }
+        Vector2D normal = (bodies.position[hit] - bodies.position[body]).normalized();
+        resolveContact(bodies, body, hit, normal, 0.0f);
+        
+        remaining *= 1.0f - t;
+        from = bodies.position[body];
+        motion = bodies.velocity[body] * (dt * remaining);
+    }
+}
+
+std::uint32_t PhysicsEngine::findImpact(std::uint32_t body, const Vector2D& from, const Vector2D& motion, float& t) {
+    const float radius = bodies.boundingRadius(body);
+    const float a = motion.dot(motion);
+    if (a == 0.0f) return body;
+    
+    // The path is searched in pieces about two cells long, in order, so a
+    // long diagonal path does not query its whole bounding box and the
+    // search ends at the first piece with a hit
+    const float length = std::sqrt(a);
+    const int pieces = static_cast<int>(
+        std::min(kMaxSweepPieces, 1.0f + length / (2.0f * uniformGrid.getCellSize())));
+    float earliest = 2.0f;
+    std::uint32_t hit = body;
+    for (int piece = 0; piece < pieces; ++piece) {
+        const float pieceEnd = static_cast<float>(piece + 1) / pieces;
+        Vector2D p0 = from + motion * (static_cast<float>(piece) / pieces);
+        Vector2D p1 = from + motion * pieceEnd;
+        sweepCandidates.clear();
+        uniformGrid.query(Vector2D(std::min(p0.x, p1.x) - radius, std::min(p0.y, p1.y) - radius),
+                          Vector2D(std::max(p0.x, p1.x) + radius, std::max(p0.y, p1.y) + radius),
+                          sweepCandidates);
+        
+        // Earliest t in [0, 1] with |from + motion t - center| = reach.
+        // Bodies still overlapped at the end, short of their center, are
+        // left to the discrete pass; any other body touching at the start
+        // is hit at once.
+        for (std::uint32_t other : sweepCandidates) {
+            if (other == body) continue;
+            const Vector2D offset = from - bodies.position[other];
+            const float reach = radius + bodies.boundingRadius(other);
+            const float b = offset.dot(motion);
+            if (b >= 0.0f) continue;  // Not approaching
+            const Vector2D endOffset = offset + motion;
+            if (endOffset.dot(endOffset) < reach * reach && endOffset.dot(motion) < 0.0f) continue;
+            const float c = offset.dot(offset) - reach * reach;
+            float time = 0.0f;
+            if (c > 0.0f) {
+                const float discriminant = b * b - a * c;
+                if (discriminant < 0.0f) continue;
+                time = (-b - std::sqrt(discriminant)) / a;
             }
-            // Bottom boundary
-            if (obj->position.y + obj->radius > height) {
-                obj->position.y = height - obj->radius;
-                obj->velocity.y *= -obj->restitution;
-                
-                // Apply resting friction
-                if (std::abs(obj->velocity.y) < 10.0f) {
-                    obj->velocity.x *= 0.95f;
-                }
+            if (time <= 1.0f && time < earliest) {
+                earliest = time;
+                hit = other;
             }
         }
+        // Later pieces can only hold later impacts
+        if (earliest <= pieceEnd) break;
     }
+    if (hit != body) t = earliest;
+    return hit;
 }
 
-bool PhysicsEngine::checkCircleCircleCollision(const PhysicsObject& a, const PhysicsObject& b) {
-    float distance = Vector2D::distance(a.position, b.position);
-    return distance < (a.radius + b.radius);
+void PhysicsEngine::measureTile(const BodyBatch& batch, size_t begin, MeasureKernel measure,
+                                BodyMoments& moments) const {
+    // The kernel weights every body; the rare tile holding static bodies,
+    // which the totals leave out, is summed body by body instead
+    const BodyMotion* motion = bodies.motion.data() + begin;
+    if (!std::memchr(motion, static_cast<int>(BodyMotion::Static), batch.count)) {
+        measure(batch, moments);
+        return;
+    }
+    
+    moments = BodyMoments();
+    for (size_t i = 0; i < batch.count; ++i) {
+        if (motion[i] == BodyMotion::Static) continue;
+        double m = batch.mass[i];
+        const Vector2D& velocity = batch.velocity[i];
+        const Vector2D& position = batch.position[i];
+        moments.kinetic += m * (double(velocity.x) * velocity.x + double(velocity.y) * velocity.y);
+        moments.momentumX += m * velocity.x;
+        moments.momentumY += m * velocity.y;
+        moments.massX += m * position.x;
+        moments.massY += m * position.y;
+        moments.mass += m;
+    }
 }
 
-void PhysicsEngine::resolveCircleCircleCollision(PhysicsObject& a, PhysicsObject& b) {
-    Vector2D normal = (b.position - a.position).normalized();
+void PhysicsEngine::combineTileMoments() {
+    BodyMoments sum;
+    for (const BodyMoments& tile : tileMoments) {
+        sum.kinetic += tile.kinetic;
+        sum.momentumX += tile.momentumX;
+        sum.momentumY += tile.momentumY;
+        sum.massX += tile.massX;
+        sum.massY += tile.massY;
+        sum.mass += tile.mass;
+    }
     
-    // Separate objects
-    float overlap = (a.radius + b.radius) - Vector2D::distance(a.position, b.position);
-    if (overlap > 0) {
-        float totalInvMass = a.getInverseMass() + b.getInverseMass();
-        if (totalInvMass > 0.0001f) {
-            Vector2D separation = normal * (overlap / totalInvMass);
-            if (!a.isStatic) a.position -= separation * a.getInverseMass();
-            if (!b.isStatic) b.position += separation * b.getInverseMass();
+    energyStats.kinetic = 0.5 * sum.kinetic;
+    // With gravity off the tree is not walked, and its potential is stale
+    if (!gravityEnabled) {
+        energyStats.potential = 0.0;
+    } else if (gravityMode == GravityMode::Mutual) {
+        energyStats.potential = mutualGravity.getPotentialEnergy();
+    } else {
+        const Vector2D floor = gravityFloor(gravity, bounds);
+        energyStats.potential = gravity.x * (floor.x * sum.mass - sum.massX) +
+                                gravity.y * (floor.y * sum.mass - sum.massY);
+    }
+    // Field potentials have no kernel; they are rare enough to sum here
+    if (!forceFields.empty()) {
+        for (size_t i = 0; i < bodies.size(); ++i) {
+            if (bodies.motion[i] == BodyMotion::Static) continue;
+            energyStats.potential += forceFields.potential(bodies.position[i], bodies.mass[i]);
         }
     }
+    energyStats.momentum = Vector2D(static_cast<float>(sum.momentumX), static_cast<float>(sum.momentumY));
+    energyStats.mass = sum.mass;
+    if (sum.mass > 0.0) {
+        energyStats.centerOfMass = Vector2D(static_cast<float>(sum.massX / sum.mass),
+                                            static_cast<float>(sum.massY / sum.mass));
+    } else {
+        energyStats.centerOfMass = Vector2D(0, 0);
+    }
+}
+
+void PhysicsEngine::handleCollisions() {
+    auto start = Clock::now();
+    switch (broadphaseMethod) {
+        case BroadphaseMethod::BruteForce:
+            // No separate broadphase: every pair goes to the narrowphase
+            handleCollisionsBruteForce();
+            lastStepTimings.broadphase = 0.0;
+            lastStepTimings.contacts = elapsedNs(start, Clock::now());
+            return;
+        case BroadphaseMethod::UniformGrid:
+            uniformGrid.findPairs(bodies, candidatePairs);
+            break;
+        case BroadphaseMethod::SweepAndPrune:
+            sweepAndPrune.findPairs(bodies, candidatePairs);
+            break;
+    }
+    auto pairsFound = Clock::now();
     
-    // Calculate relative velocity
-    Vector2D relativeVelocity = b.velocity - a.velocity;
-    float velocityAlongNormal = relativeVelocity.dot(normal);
-    
-    // Don't resolve if objects are separating
-    if (velocityAlongNormal > 0) return;
+    // Sleepers touched by awake bodies wake before resolution, so the
+    // contact sees their real mass
+    contactSolver.findContacts(bodies, candidatePairs, threadPool);
+    if (canSleep()) {
+        sleepManager.wakeTouched(bodies, contactSolver.getContacts(), wakeVelocity);
+    }
+    contactSolver.resolve(bodies, threadPool);
+    lastStepTimings.broadphase = elapsedNs(start, pairsFound);
+    lastStepTimings.contacts = elapsedNs(pairsFound, Clock::now());
+}
+
+void PhysicsEngine::handleCollisionsBruteForce() {
+    // Check all pairs of objects
+    const size_t count = bodies.size();
+    for (size_t i = 0; i < count; ++i) {
+        for (size_t j = i + 1; j < count; ++j) {
+            if (bodies.invMass[i] == 0.0f && bodies.invMass[j] == 0.0f) continue;
+            collidePair(bodies, i, j);
+        }
+    }
+}
+
+bool PhysicsEngine::canSleep() const {
+    // Under mutual gravity the field moves with the bodies, so nothing rests
+    bool mutual = gravityEnabled && gravityMode == GravityMode::Mutual;
+    return sleepingEnabled && collisionsEnabled && !mutual && broadphaseMethod != BroadphaseMethod::BruteForce;
+}
+
+void PhysicsEngine::updateSleep(float dt, const std::vector<BodyPair>& contacts) {
+    if (!canSleep()) {
+        if (sleepManager.getSleepingCount() > 0) sleepManager.wakeAll(bodies);
+        return;
+    }
     
-    // Calculate restitution
-    float e = std::min(a.restitution, b.restitution);
+    // Sleepers rested under the old gravity; a change must move them
+    Vector2D effectiveGravity = gravityEnabled ? gravity : Vector2D(0, 0);
+    if (effectiveGravity.x != sleepGravity.x || effectiveGravity.y != sleepGravity.y) {
+        sleepManager.wakeAll(bodies);
+        sleepGravity = effectiveGravity;
+    }
     
-    // Calculate impulse scalar
-    float j = -(1 + e) * velocityAlongNormal;
-    j /= a.getInverseMass() + b.getInverseMass();
+    float maxDrift = sleepVelocity * timeToSleep;
+    sleepManager.update(bodies, contacts, maxDrift, timeToSleep, dt);
+}
+
+void PhysicsEngine::handleBoundaryCollisions(float width, float height) {
+    if (!boundaryEnabled) return;
     
-    // Apply impulse
-    Vector2D impulse = normal * j;
-    if (!a.isStatic) a.velocity -= impulse * a.getInverseMass();
-    if (!b.isStatic) b.velocity += impulse * b.getInverseMass();
+    forEachBodyRange([this, width, height](size_t begin, size_t end) {
+        applyBoundary(begin, end, width, height);
+    });
+}
+
+void PhysicsEngine::applyBoundary(size_t begin, size_t end, float width, float height) {
+    for (size_t i = begin; i < end; ++i) {
+        if (bodies.invMass[i] == 0.0f) continue;
+        
+        Vector2D& position = bodies.position[i];
+        Vector2D& velocity = bodies.velocity[i];
+        Vector2D half = bodies.halfExtents(i);
+        float restitution = bodies.restitution[i];
+        
+        // Left boundary
+        if (position.x - half.x < 0) {
+            position.x = half.x;
+            velocity.x *= -restitution;
+        }
+        // Right boundary
+        if (position.x + half.x > width) {
+            position.x = width - half.x;
+            velocity.x *= -restitution;
+        }
+        // Top boundary
+        if (position.y - half.y < 0) {
+            position.y = half.y;
+            velocity.y *= -restitution;
+        }
+        // Bottom boundary
+        if (position.y + half.y > height) {
+            position.y = height - half.y;
+            velocity.y *= -restitution;
+            
+            // Apply resting friction
+            if (std::abs(velocity.y) < 10.0f) {
+                velocity.x *= 0.95f;
+            }
+        }
+    }
 }
 
 float PhysicsEngine::getTotalKineticEnergy() const {
-    float total = 0.0f;
-    for (const auto& obj : objects) {
-        total += obj->getKineticEnergy();
+    double total = 0.0;
+    const size_t count = bodies.size();
+    for (size_t i = 0; i < count; ++i) {
+        if (bodies.motion[i] != BodyMotion::Static) {
+            total += 0.5 * bodies.mass[i] * bodies.velocity[i].magnitudeSquared();
+        }
     }
-    return total;
+    return static_cast<float>(total);
 }
 
 float PhysicsEngine::getTotalPotentialEnergy() const {
-    float total = 0.0f;
-    float g = gravity.magnitude();
-    for (const auto& obj : objects) {
-        total += obj->getPotentialEnergy(g);
+    const bool mutual = gravityEnabled && gravityMode == GravityMode::Mutual;
+    double total = mutual ? mutualGravity.getPotentialEnergy() : 0.0;
+    const Vector2D pull = gravityEnabled && !mutual ? gravity : Vector2D(0, 0);
+    const Vector2D floor = gravityFloor(pull, bounds);
+    const bool hasFields = !forceFields.empty();
+    const size_t count = bodies.size();
+    for (size_t i = 0; i < count; ++i) {
+        if (bodies.motion[i] == BodyMotion::Static) continue;
+        const Vector2D& position = bodies.position[i];
+        total += double(bodies.mass[i]) * (double(pull.x) * (floor.x - position.x) +
+                                           double(pull.y) * (floor.y - position.y));
+        if (hasFields) {
+            total += forceFields.potential(position, bodies.mass[i]);
+        }
     }
-    return total;
+    return static_cast<float>(total);
 }
 
 float PhysicsEngine::getTotalEnergy() const {
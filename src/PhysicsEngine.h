@@ -1,40 +1,143 @@
 #pragma once
 #include "PhysicsObject.h"
+#include "BarnesHutGravity.h"
+#include "BodyStorage.h"
+#include "Broadphase.h"
+#include "ContactSolver.h"
+#include "ForceFields.h"
+#include "SimdKernels.h"
+#include "SleepManager.h"
+#include "ThreadPool.h"
+#include "XpbdSolver.h"
+#include <cstdint>
 #include <vector>
-#include <memory>
 
 namespace Physica {
 
+// Wall-clock time spent in each phase of one update(), in nanoseconds
+struct StepTimings {
+    double integrate = 0.0;   // forces and integration
+    double sweep = 0.0;       // continuous collision of fast bodies
+    double broadphase = 0.0;  // candidate pair search
+    double contacts = 0.0;    // narrowphase and contact resolution
+};
+
+// Totals over all non-static bodies, measured by update() right after
+// integration, before collisions. Sums are accumulated in double per tile
+// and the tile partials added in a fixed order, so the result does not
+// depend on the thread count.
+struct EnergyStats {
+    double kinetic = 0.0;
+    double potential = 0.0;  // Gravity (see getTotalPotentialEnergy) plus force fields
+    Vector2D momentum;
+    Vector2D centerOfMass;
+    double mass = 0.0;
+    
+    double total() const { return kinetic + potential; }
+};
+
+// Observables recorded by step() every `sampleEvery` steps
+struct StepSample {
+    std::uint64_t step;  // getStepCount() after the sampled step
+    EnergyStats energy;
+};
+
 class PhysicsEngine {
 public:
     PhysicsEngine();
     
-    // Simulation control
+    // Simulation control. update() is one step without the walls;
+    // step() runs `count` full steps, walls included, in one call. The
+    // walls of each step are applied inside the next step's integration
+    // pass while the bodies are in cache. With `samples`, the energy
+    // stats of every step whose count is a multiple of `sampleEvery` are
+    // appended; other steps skip measuring them, except the last. With
+    // IntegrationMethod::Xpbd the walls are constraints solved in every
+    // substep instead.
     void update(float dt);
+    void step(size_t count, float dt, std::vector<StepSample>* samples = nullptr, size_t sampleEvery = 1);
+    std::uint64_t getStepCount() const { return stepCount; }
+    void setStepCount(std::uint64_t count) { stepCount = count; }
     void reset();
     
-    // Object management
-    void addObject(std::shared_ptr<PhysicsObject> object);
+    // Object management. Removal is O(1) and moves the last body into the
+    // removed one's index, so keep handles, not indices, across removals.
+    size_t addObject(const PhysicsObject& object);
     void removeObject(size_t index);
+    bool removeObject(BodyHandle handle);  // false if already removed
     void clearObjects();
-    std::vector<std::shared_ptr<PhysicsObject>>& getObjects() { return objects; }
+    size_t getObjectCount() const { return bodies.size(); }
+    BodyRef getObject(size_t index) { return BodyRef(bodies, index); }
+    BodyHandle getHandle(size_t index) const { return bodies.handle(index); }
+    std::optional<size_t> findObject(BodyHandle handle) const { return bodies.find(handle); }
+    BodyStorage& getBodies() { return bodies; }
+    const BodyStorage& getBodies() const { return bodies; }
+    // Call after replacing the body arrays wholesale (e.g. from a
+    // snapshot): resets handles, broadphase and sleep bookkeeping to match them
+    void resyncBodies();
     
     // Physics parameters
     void setGravity(const Vector2D& g) { gravity = g; }
     Vector2D getGravity() const { return gravity; }
     void setIntegrationMethod(IntegrationMethod method) { integrationMethod = method; }
     IntegrationMethod getIntegrationMethod() const { return integrationMethod; }
+    void setBroadphaseMethod(BroadphaseMethod method);
+    BroadphaseMethod getBroadphaseMethod() const { return broadphaseMethod; }
+    
+    // Mutual gravity: bodies attract each other instead of falling along
+    // the gravity vector. gravityEnabled switches either mode off. Tune the
+    // tree (theta, softening, G) through getMutualGravity().
+    void setGravityMode(GravityMode mode);
+    GravityMode getGravityMode() const { return gravityMode; }
+    BarnesHutGravity& getMutualGravity() { return mutualGravity; }
+    const BarnesHutGravity& getMutualGravity() const { return mutualGravity; }
+    
+    // Sleeping: bodies that rest for timeToSleep seconds leave the contact
+    // solve until something touches their island; they are still stepped
+    // and inserted in the broadphase. Call wakeObject after moving or
+    // pushing a body by hand. Not used with the brute-force broadphase,
+    // which does not report contacts.
+    void wakeObject(size_t index) { sleepManager.wakeBody(bodies, index); }
+    void wakeAllObjects() { sleepManager.wakeAll(bodies); }
+    size_t getSleepingCount() const { return sleepManager.getSleepingCount(); }
     
-    // Force application
-    void applyGravity();
-    void applyFriction();
-    void applyAirResistance(float coefficient);
+    // Worker threads used for per-body passes (0 = one per core)
+    void setThreadCount(size_t count) { threadPool.setThreadCount(count); }
+    size_t getThreadCount() const { return threadPool.getThreadCount(); }
+    ContactSolver& getContactSolver() { return contactSolver; }
+    // Substep count and compliances of IntegrationMethod::Xpbd
+    XpbdSolver& getXpbdSolver() { return xpbd; }
+    const XpbdSolver& getXpbdSolver() const { return xpbd; }
+    const StepTimings& getLastStepTimings() const { return lastStepTimings; }
     
-    // Collision detection and response
+    // User force fields, applied with gravity, friction and drag in the
+    // same pass as integration
+    template <typename Field>
+    void addForceField(const Field& field) {
+        forceFields.add(field);
+        wakeAllObjects();
+    }
+    void clearForceFields() {
+        forceFields.clear();
+        wakeAllObjects();
+    }
+    const ForceFieldPipeline& getForceFields() const { return forceFields; }
+    
+    // Collision detection and response. step() keeps bodies inside the
+    // box from (0, 0) to the bounds.
     void handleCollisions();
     void handleBoundaryCollisions(float width, float height);
+    void setBounds(float width, float height) { bounds = Vector2D(width, height); }
+    Vector2D getBounds() const { return bounds; }
     
-    // Energy tracking
+    // Energy tracking. getEnergyStats is free: it is gathered during the
+    // last measured step. The getTotal* functions make a fresh pass over the
+    // bodies. Uniform gravity's potential energy is m g h, with the height h
+    // measured from the wall gravity pulls towards, so it is never negative
+    // inside the bounds; in mutual gravity mode it is the one found by the
+    // last update's tree walk. With gravity off it is zero. Force fields
+    // add their potentials.
+    const EnergyStats& getEnergyStats() const { return energyStats; }
     float getTotalKineticEnergy() const;
     float getTotalPotentialEnergy() const;
     float getTotalEnergy() const;
@@ -44,20 +147,90 @@ public:
     bool collisionsEnabled = true;
     bool boundaryEnabled = true;
     float airResistanceCoefficient = 0.01f;
+    bool simdEnabled = true;  // false forces the scalar reference kernels
+    bool sleepingEnabled = true;
+    float sleepVelocity = 10.0f; // Mean speed (pixels/s) over timeToSleep counted as resting
+    float timeToSleep = 0.5f;    // seconds
+    float wakeVelocity = 50.0f;  // Impact speed (pixels/s) that wakes a sleeping island
+    // Continuous collision: a body moving more than ccdThreshold times its
+    // bounding radius in one step, or flagged as a bullet, is swept from
+    // its start to its end position as a circle. At the earliest time of
+    // impact it stops, bounces off the body it hit, and spends the rest of
+    // the step moving with its new velocity (up to maxSweepImpacts times).
+    // The other bodies are taken at their end positions. The default
+    // threshold, one diameter, is as far as a body can move and still be
+    // caught by the discrete pass against bodies at least its size; flag
+    // bodies aimed at thinner ones as bullets. Walls need no sweep: they
+    // clamp positions.
+    bool continuousCollisionEnabled = true;
+    float ccdThreshold = 2.0f;
+    int maxSweepImpacts = 4;
     
 private:
-    std::vector<std::shared_ptr<PhysicsObject>> objects;
+    BodyStorage bodies;
     Vector2D gravity;
+    Vector2D bounds;
+    std::uint64_t stepCount = 0;
     IntegrationMethod integrationMethod;
+    BroadphaseMethod broadphaseMethod;
+    ThreadPool threadPool;
+    ForceFieldPipeline forceFields;
+    GravityMode gravityMode;
+    BarnesHutGravity mutualGravity;
+    
+    // Broadphase state, reused every step
+    UniformGridBroadphase uniformGrid;
+    SweepAndPruneBroadphase sweepAndPrune;
+    std::vector<BodyPair> candidatePairs;
+    ContactSolver contactSolver;
+    XpbdSolver xpbd;
+    std::vector<Vector2D> substepForce;  // Each body's applied force, reused by every substep
+    SleepManager sleepManager;
+    Vector2D sleepGravity;  // Gravity the sleeping bodies came to rest under
+    StepTimings lastStepTimings;
+    EnergyStats energyStats;
+    std::vector<BodyMoments> tileMoments;  // Per integration tile, combined in tile order
+    
+    // Continuous collision state, reused every step
+    struct Sweep {
+        std::uint32_t body;
+        Vector2D start;  // Position before integration
+    };
+    std::vector<std::vector<Sweep>> tileSweeps;  // Fast bodies found by each integration tile
+    std::vector<std::uint32_t> sweepCandidates;
+    
+    // Runs fn(begin, end) over all bodies, split across the thread pool
+    template <typename Fn>
+    void forEachBodyRange(Fn&& fn);
     
-    // Integration methods
-    void integrateEuler(PhysicsObject& obj, float dt);
-    void integrateSemiImplicitEuler(PhysicsObject& obj, float dt);
-    void integrateVerlet(PhysicsObject& obj, float dt);
+    // Pointers into the body arrays for [begin, end)
+    BodyBatch makeBatch(size_t begin, size_t end);
+    
+    // One step. With wallsFirst, the previous step's walls are applied
+    // first, tile by tile in the integration pass. Energy stats are only
+    // gathered when `measure` is set.
+    void advance(float dt, bool wallsFirst, bool measure);
+    // One IntegrationMethod::Xpbd step, which applies its own walls
+    // (when `walls` is set) inside every substep
+    void advanceSubsteps(float dt, bool walls, bool measure);
+    float substepPairMargin(float dt) const;
+    void applyBoundary(size_t begin, size_t end, float width, float height);
+    
+    void findSweeps(size_t begin, size_t end, const Vector2D* start, std::vector<Sweep>& out) const;
+    void sweepFastBodies(float dt);
+    void resolveSweep(const Sweep& sweep, float dt);
+    // Earliest body hit moving `motion` from `from`, setting t to the
+    // fraction of the motion before impact; returns `body` for no hit
+    std::uint32_t findImpact(std::uint32_t body, const Vector2D& from, const Vector2D& motion, float& t);
+    
+    void measureTile(const BodyBatch& batch, size_t begin, MeasureKernel measure, BodyMoments& moments) const;
+    void combineTileMoments();
     
     // Collision helpers
-    bool checkCircleCircleCollision(const PhysicsObject& a, const PhysicsObject& b);
-    void resolveCircleCircleCollision(PhysicsObject& a, PhysicsObject& b);
+    void handleCollisionsBruteForce();
+    
+    bool canSleep() const;
+    void updateSleep(float dt, const std::vector<BodyPair>& contacts);
 };
 
 } // namespace Physica
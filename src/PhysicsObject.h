@@ -13,16 +13,21 @@ enum class ShapeType {
 enum class IntegrationMethod {
     Euler,
     SemiImplicitEuler,
-    Verlet
+    Verlet,
+    Xpbd,            // Substepped extended position-based dynamics (see XpbdSolver)
+    VelocityVerlet,  // Two force evaluations per step (see StagedIntegrators)
+    Rk4              // Classic fourth-order Runge-Kutta, four force evaluations
 };
 
+// Description of a single body. PhysicsEngine copies it into its
+// structure-of-arrays storage (see BodyStorage) when the body is added.
 class PhysicsObject {
 public:
     // Basic properties
     Vector2D position;
     Vector2D velocity;
     Vector2D acceleration;
-    Vector2D previousPosition; // For Verlet integration
+    Vector2D previousPosition; // Where the last Verlet step started
     
     float mass;
     float radius; // For circles
@@ -32,6 +37,7 @@ public:
     float restitution; // Coefficient of restitution (bounciness)
     float friction;
     bool isStatic;
+    bool isBullet;  // Always swept by continuous collision detection
     
     ShapeType shape;
     
@@ -45,7 +51,7 @@ public:
     PhysicsObject(Vector2D pos, float mass, ShapeType shape = ShapeType::Circle)
         : position(pos), velocity(0, 0), acceleration(0, 0), previousPosition(pos),
           mass(mass), radius(20.0f), width(40.0f), height(40.0f),
-          restitution(0.8f), friction(0.1f), isStatic(false),
+          restitution(0.8f), friction(0.1f), isStatic(false), isBullet(false),
           shape(shape), colorR(0.3f), colorG(0.7f), colorB(1.0f),
           forceAccumulator(0, 0) {}
     
@@ -0,0 +1,201 @@
+#include "PhysicsThread.h"
+#include <algorithm>
+
+namespace Physica {
+
+float SimulationSnapshot::alphaAt(std::chrono::steady_clock::time_point now) const {
+    float seconds = std::chrono::duration<float>(now - publishedAt).count();
+    return std::min(1.0f, alpha + seconds * stepRate);
+}
+
+void SimulationSnapshot::interpolate(float t, AlignedVector<Vector2D>& out) const {
+    const AlignedVector<Vector2D>& current = bodies.position;
+    out.resize(current.size());
+    if (previousPosition.size() != current.size()) {
+        std::copy(current.begin(), current.end(), out.begin());
+        return;
+    }
+    for (size_t i = 0; i < current.size(); ++i) {
+        out[i] = previousPosition[i] + (current[i] - previousPosition[i]) * t;
+    }
+}
+
+PhysicsThread::PhysicsThread(std::unique_ptr<PhysicsEngine> engine, float fixedTimeStep)
+    : engine(std::move(engine)), fixedTimeStep(fixedTimeStep) {
+    thread = std::thread([this] { run(); });
+}
+
+PhysicsThread::~PhysicsThread() {
+    {
+        std::lock_guard<std::mutex> lock(commandMutex);
+        stopping = true;
+    }
+    commandCondition.notify_one();
+    thread.join();
+}
+
+void PhysicsThread::post(Command command) {
+    {
+        std::lock_guard<std::mutex> lock(commandMutex);
+        pendingCommands.push_back(std::move(command));
+    }
+    commandCondition.notify_one();
+}
+
+void PhysicsThread::setPaused(bool value) {
+    post([this, value](PhysicsEngine&) { paused = value; });
+}
+
+void PhysicsThread::setSpeed(float value) {
+    post([this, value](PhysicsEngine&) { speed = value; });
+}
+
+void PhysicsThread::stepOnce() {
+    post([this](PhysicsEngine&) { ++requestedSteps; });
+}
+
+void PhysicsThread::restartClock() {
+    post([this](PhysicsEngine&) {
+        stepCount = 0;
+        simulatedTime = 0.0f;
+        EnergySample marker{};
+        marker.restart = true;
+        tickSamples.push_back(marker);
+    });
+}
+
+void PhysicsThread::startRecording(const std::string& path) {
+    post([this, path](PhysicsEngine& engine) {
+        // The first frame is the state recording started from
+        if (recorder.start(path, fixedTimeStep)) {
+            recorder.record(engine.getBodies(), engine.getStepCount());
+        }
+    });
+}
+
+void PhysicsThread::stopRecording() {
+    post([this](PhysicsEngine&) { recorder.stop(); });
+}
+
+void PhysicsThread::predictTrajectory(BodyHandle body, const Vector2D& position, const Vector2D& velocity) {
+    post([this, body, position, velocity](PhysicsEngine& engine) {
+        if (std::optional<size_t> index = engine.findObject(body)) {
+            predictor.predict(engine, *index, position, velocity, fixedTimeStep);
+        } else {
+            predictor.clear();
+        }
+    });
+}
+
+void PhysicsThread::clearTrajectory() {
+    post([this](PhysicsEngine&) { predictor.clear(); });
+}
+
+void PhysicsThread::takeEnergySamples(std::vector<EnergySample>& out) {
+    std::lock_guard<std::mutex> lock(energyMutex);
+    out.insert(out.end(), energySamples.begin(), energySamples.end());
+    energySamples.clear();
+}
+
+void PhysicsThread::run() {
+    using Clock = std::chrono::steady_clock;
+    std::vector<Command> commands;
+    Clock::time_point last = Clock::now();
+    float accumulator = 0.0f;
+
+    while (true) {
+        {
+            // Sleep until the next step is due or a command arrives
+            std::unique_lock<std::mutex> lock(commandMutex);
+            if (pendingCommands.empty() && !stopping) {
+                bool running = !paused && speed > 0.0f;
+                float wait = running ? (fixedTimeStep - accumulator) / speed : kMaxCatchUp;
+                commandCondition.wait_for(lock, std::chrono::microseconds(static_cast<long long>(wait * 1e6f)));
+            }
+            if (stopping) break;
+            commands.swap(pendingCommands);
+        }
+
+        const bool changed = !commands.empty();
+        for (Command& command : commands) {
+            command(*engine);
+        }
+        commands.clear();
+
+        Clock::time_point now = Clock::now();
+        float elapsed = std::min(std::chrono::duration<float>(now - last).count(), kMaxCatchUp);
+        last = now;
+
+        int due = requestedSteps;
+        requestedSteps = 0;
+        if (!paused && speed > 0.0f) {
+            accumulator += elapsed * speed;
+            due = static_cast<int>(accumulator / fixedTimeStep);
+            accumulator -= due * fixedTimeStep;
+        }
+
+        if (recorder.isRecording()) {
+            // Every step goes to the replay, so steps cannot be batched
+            for (int i = 0; i < due; ++i) {
+                if (i == due - 1) {
+                    stepStartPosition = engine->getBodies().position;
+                }
+                engine->step(1, fixedTimeStep, &stepSamples);
+                recorder.record(engine->getBodies(), engine->getStepCount());
+            }
+        } else {
+            // Catch-up steps run as one batch; only the last step's start
+            // is needed for interpolation
+            if (due > 1) {
+                engine->step(due - 1, fixedTimeStep, &stepSamples);
+            }
+            if (due > 0) {
+                stepStartPosition = engine->getBodies().position;
+                engine->step(1, fixedTimeStep, &stepSamples);
+            }
+        }
+        for (const StepSample& step : stepSamples) {
+            ++stepCount;
+            simulatedTime += fixedTimeStep;
+            const EnergyStats& stats = step.energy;
+            EnergySample sample;
+            sample.data = {simulatedTime, static_cast<float>(stats.kinetic),
+                           static_cast<float>(stats.potential), static_cast<float>(stats.total())};
+            tickSamples.push_back(sample);
+        }
+        stepSamples.clear();
+
+        if (!tickSamples.empty()) {
+            std::lock_guard<std::mutex> lock(energyMutex);
+            energySamples.insert(energySamples.end(), tickSamples.begin(), tickSamples.end());
+            tickSamples.clear();
+        }
+
+        if (due > 0 || changed) {
+            if (due == 0) {
+                stepStartPosition = engine->getBodies().position;
+            }
+            publish(paused ? 1.0f : accumulator / fixedTimeStep);
+        }
+    }
+}
+
+void PhysicsThread::publish(float alpha) {
+    SimulationSnapshot& snapshot = snapshots.writeBuffer();
+    snapshot.bodies = engine->getBodies();
+    snapshot.previousPosition = stepStartPosition;
+    snapshot.gravity = engine->getGravity();
+    snapshot.gravityEnabled = engine->gravityEnabled;
+    snapshot.gravityMode = engine->getGravityMode();
+    snapshot.broadphaseMethod = engine->getBroadphaseMethod();
+    snapshot.step = stepCount;
+    snapshot.time = simulatedTime;
+    snapshot.recording = recorder.isRecording();
+    snapshot.trajectory = predictor.getPoints();
+    snapshot.alpha = alpha;
+    snapshot.stepRate = paused ? 0.0f : speed / fixedTimeStep;
+    snapshot.publishedAt = std::chrono::steady_clock::now();
+    snapshots.publish();
+}
+
+} // namespace Physica
@@ -0,0 +1,132 @@
+#pragma once
+#include "EnergyHistory.h"
+#include "PhysicsEngine.h"
+#include "ReplayRecorder.h"
+#include "TrajectoryPredictor.h"
+#include "TripleBuffer.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Physica {
+
+// Engine state after one fixed step, published by PhysicsThread for the
+// render thread. Snapshots are never modified once published.
+struct SimulationSnapshot {
+    BodyStorage bodies;                        // State after the latest step
+    AlignedVector<Vector2D> previousPosition;  // Positions one step earlier
+    Vector2D gravity;
+    bool gravityEnabled = true;
+    GravityMode gravityMode = GravityMode::Uniform;
+    BroadphaseMethod broadphaseMethod = BroadphaseMethod::UniformGrid;
+    std::uint64_t step = 0;  // Steps taken since the clock was restarted
+    float time = 0.0f;       // Simulated seconds since the clock was restarted
+    bool recording = false;  // A replay is being recorded
+    AlignedVector<Vector2D> trajectory;  // Latest predictTrajectory() path
+
+    // Accumulator left over at publish time, as a fraction of a step, and
+    // how fast it grows (steps per wall-clock second, 0 while paused)
+    float alpha = 0.0f;
+    float stepRate = 0.0f;
+    std::chrono::steady_clock::time_point publishedAt;
+
+    // Fraction of the way from previousPosition to bodies.position that
+    // the simulation has reached at `now`
+    float alphaAt(std::chrono::steady_clock::time_point now) const;
+
+    // Positions blended between the last two steps
+    void interpolate(float t, AlignedVector<Vector2D>& out) const;
+};
+
+// One energy sample per fixed step. A `restart` entry carries no data: it
+// marks where restartClock() took effect, so the receiver drops the
+// samples before it.
+struct EnergySample {
+    EnergyData data;
+    bool restart = false;
+};
+
+// Runs a PhysicsEngine at a fixed time step on its own thread, decoupled
+// from the frame rate. Nothing outside the thread touches the engine:
+// input goes in through post(), which queues a command to run on the
+// physics thread between steps, in order. State comes out as snapshots
+// through a lock-free triple buffer, and energy samples through a queue.
+class PhysicsThread {
+public:
+    using Command = std::function<void(PhysicsEngine&)>;
+
+    PhysicsThread(std::unique_ptr<PhysicsEngine> engine, float fixedTimeStep);
+    ~PhysicsThread();
+
+    PhysicsThread(const PhysicsThread&) = delete;
+    PhysicsThread& operator=(const PhysicsThread&) = delete;
+
+    void post(Command command);
+
+    // Controls, applied in order with the posted commands
+    void setPaused(bool paused);
+    void setSpeed(float speed);
+    void stepOnce();      // One step while paused
+    void restartClock();  // Simulated time back to zero
+
+    // Records every step to a replay file until stopRecording()
+    void startRecording(const std::string& path);
+    void stopRecording();
+
+    // Predicts the path of a body if launched from `position` with
+    // `velocity` (see TrajectoryPredictor); it appears in the snapshots
+    // until the next prediction or clearTrajectory()
+    void predictTrajectory(BodyHandle body, const Vector2D& position, const Vector2D& velocity);
+    void clearTrajectory();
+
+    // Render thread: the newest snapshot, valid until the next call
+    const SimulationSnapshot& acquireSnapshot() { return snapshots.acquire(); }
+
+    // Moves the samples produced since the last call into `out`
+    void takeEnergySamples(std::vector<EnergySample>& out);
+
+    float getFixedTimeStep() const { return fixedTimeStep; }
+
+    // Longest wall-clock time one tick catches up on (prevents the spiral
+    // of death when steps take longer than real time)
+    static constexpr float kMaxCatchUp = 0.1f;
+
+private:
+    std::unique_ptr<PhysicsEngine> engine;
+    const float fixedTimeStep;
+    std::thread thread;
+
+    // Commands from other threads, swapped out once per tick
+    std::mutex commandMutex;
+    std::condition_variable commandCondition;
+    std::vector<Command> pendingCommands;
+    bool stopping = false;
+
+    std::mutex energyMutex;
+    std::vector<EnergySample> energySamples;
+
+    TripleBuffer<SimulationSnapshot> snapshots;
+
+    // Physics thread state
+    bool paused = false;
+    float speed = 1.0f;
+    int requestedSteps = 0;
+    std::uint64_t stepCount = 0;
+    float simulatedTime = 0.0f;
+    std::vector<StepSample> stepSamples;
+    std::vector<EnergySample> tickSamples;
+    AlignedVector<Vector2D> stepStartPosition;
+    ReplayRecorder recorder;
+    TrajectoryPredictor predictor;
+
+    void run();
+    void publish(float alpha);
+};
+
+} // namespace Physica
@@ -1,4 +1,5 @@
 #include "Renderer.h"
+#include <algorithm>
 #include <cmath>
 #include <sstream>
 #include <iomanip>
@@ -6,69 +7,208 @@
 
 namespace Physica {
 
+namespace {
+
+// Shape texture: a disc kDiscSize texels across on the left, solid white
+// on the right
+constexpr unsigned kDiscSize = 64;
+constexpr float kDiscRadius = kDiscSize * 0.5f;
+const sf::Vector2f kSolidTexel(kDiscSize * 1.5f, kDiscSize * 0.5f);
+
+constexpr size_t kVerticesPerQuad = 6;
+constexpr size_t kVerticesPerBody = 2 * kVerticesPerQuad;       // Outline, then fill
+constexpr size_t kVerticesPerArrow = kVerticesPerQuad + 3;       // Shaft, then head
+constexpr float kOutlineThickness = 2.0f;
+
+// Bodies per fill chunk: each one writes a few hundred bytes of vertices
+constexpr size_t kMinBodiesPerFill = 1024;
+// The frame thread and one worker; the engine's pool has a thread per core
+constexpr size_t kFillThreads = 2;
+
+// Writes an axis-aligned quad as two triangles. The texture rectangle
+// collapses to one texel when `disc` is false.
+void putQuad(sf::Vertex* v, const Vector2D& center, float halfWidth, float halfHeight, sf::Color color,
+             bool disc) {
+    const sf::Vector2f corners[4] = {
+        {center.x - halfWidth, center.y - halfHeight},
+        {center.x + halfWidth, center.y - halfHeight},
+        {center.x + halfWidth, center.y + halfHeight},
+        {center.x - halfWidth, center.y + halfHeight},
+    };
+    const float size = static_cast<float>(kDiscSize);
+    const sf::Vector2f texCoords[4] = {
+        disc ? sf::Vector2f(0, 0) : kSolidTexel,
+        disc ? sf::Vector2f(size, 0) : kSolidTexel,
+        disc ? sf::Vector2f(size, size) : kSolidTexel,
+        disc ? sf::Vector2f(0, size) : kSolidTexel,
+    };
+    const int order[kVerticesPerQuad] = {0, 1, 2, 0, 2, 3};
+    for (size_t i = 0; i < kVerticesPerQuad; ++i) {
+        v[i] = sf::Vertex{corners[order[i]], color, texCoords[order[i]]};
+    }
+}
+
+// Writes a line with an arrowhead at `end`
+void putArrow(sf::Vertex* v, const Vector2D& start, const Vector2D& end, sf::Color color) {
+    Vector2D direction = (end - start).normalized();
+    Vector2D perpendicular(-direction.y, direction.x);
+    Vector2D halfWidth = perpendicular * 0.75f;
+    
+    const Vector2D shaft[4] = {start - halfWidth, start + halfWidth, end + halfWidth, end - halfWidth};
+    const int order[kVerticesPerQuad] = {0, 1, 2, 0, 2, 3};
+    for (size_t i = 0; i < kVerticesPerQuad; ++i) {
+        v[i] = sf::Vertex{{shaft[order[i]].x, shaft[order[i]].y}, color, kSolidTexel};
+    }
+    
+    float arrowSize = 8.0f;
+    Vector2D left = end - direction * arrowSize + perpendicular * (arrowSize * 0.5f);
+    Vector2D right = end - direction * arrowSize - perpendicular * (arrowSize * 0.5f);
+    v[6] = sf::Vertex{{end.x, end.y}, color, kSolidTexel};
+    v[7] = sf::Vertex{{left.x, left.y}, color, kSolidTexel};
+    v[8] = sf::Vertex{{right.x, right.y}, color, kSolidTexel};
+}
+
+// Fills an arrow slot that has nothing to show with invisible, zero-area
+// triangles, so every body keeps a fixed slot
+void putEmptyArrow(sf::Vertex* v, const Vector2D& at) {
+    for (size_t i = 0; i < kVerticesPerArrow; ++i) {
+        v[i] = sf::Vertex{{at.x, at.y}, sf::Color::Transparent, kSolidTexel};
+    }
+}
+
+} // namespace
+
 Renderer::Renderer(sf::RenderWindow& window)
-    : window(window), fontLoaded(false) {
+    : window(window), fontLoaded(false), labels(font, 12),
+      bodyVertices(sf::PrimitiveType::Triangles), vectorVertices(sf::PrimitiveType::Triangles),
+      predictionLine(sf::PrimitiveType::LineStrip), predictionDots(sf::PrimitiveType::Triangles),
+      fillPool(kFillThreads), gridBuffer(sf::PrimitiveType::Lines, sf::VertexBuffer::Usage::Static) {
     // Try to load a system font (fallback to default if not found)
     fontLoaded = font.openFromFile("/System/Library/Fonts/Helvetica.ttc");
     if (!fontLoaded) {
         fontLoaded = font.openFromFile("/usr/share/fonts/truetype/dejavu/DejaVuSans.ttf");
     }
+    buildShapeTexture();
 }
 
-void Renderer::render(const std::vector<std::shared_ptr<PhysicsObject>>& objects) {
-    if (showGrid) {
-        renderGrid(50.0f);
+void Renderer::buildShapeTexture() {
+    sf::Image image({2 * kDiscSize, kDiscSize}, sf::Color::White);
+    for (unsigned y = 0; y < kDiscSize; ++y) {
+        for (unsigned x = 0; x < kDiscSize; ++x) {
+            // Coverage of the texel by the disc, over a one-texel edge
+            float dx = x + 0.5f - kDiscRadius;
+            float dy = y + 0.5f - kDiscRadius;
+            float coverage = std::clamp(kDiscRadius - std::sqrt(dx * dx + dy * dy), 0.0f, 1.0f);
+            image.setPixel({x, y}, sf::Color(255, 255, 255, static_cast<std::uint8_t>(coverage * 255)));
+        }
     }
-    
-    for (const auto& obj : objects) {
-        renderObject(*obj);
-        renderVectors(*obj, showVelocityVectors, showForceVectors);
+    if (shapeTexture.loadFromImage(image)) {
+        shapeTexture.setSmooth(true);
     }
 }
 
-void Renderer::renderObject(const PhysicsObject& obj) {
-    sf::Color color(
-        static_cast<std::uint8_t>(obj.colorR * 255),
-        static_cast<std::uint8_t>(obj.colorG * 255),
-        static_cast<std::uint8_t>(obj.colorB * 255)
-    );
+void Renderer::render(const BodyStorage& bodies, const AlignedVector<Vector2D>& positions) {
+    if (showGrid) {
+        renderGrid(gridSpacing);
+    }
+    
+    const size_t count = bodies.size();
+    sf::RenderStates states(&shapeTexture);
     
-    // Dimmer color for static objects
-    if (obj.isStatic) {
-        color = sf::Color(color.r / 2, color.g / 2, color.b / 2);
+    bodyVertices.resize(count * kVerticesPerBody);
+    fillPool.parallelFor(count, kMinBodiesPerFill, 1, [&](size_t begin, size_t end) {
+        fillBodies(bodies, positions, begin, end);
+    });
+    if (count > 0) {
+        window.draw(bodyVertices, states);
     }
     
-    if (obj.shape == ShapeType::Circle) {
-        drawCircle(obj.position, obj.radius, color);
-    } else if (obj.shape == ShapeType::Box) {
-        drawBox(obj.position, obj.width, obj.height, color);
+    const size_t arrowsPerBody = (showVelocityVectors ? 1 : 0) + (showForceVectors ? 1 : 0);
+    vectorVertices.resize(count * arrowsPerBody * kVerticesPerArrow);
+    if (arrowsPerBody > 0 && count > 0) {
+        fillPool.parallelFor(count, kMinBodiesPerFill, 1, [&](size_t begin, size_t end) {
+            fillVectors(bodies, positions, begin, end);
+        });
+        window.draw(vectorVertices, states);
     }
     
-    // Draw label
-    if (showLabels && fontLoaded && !obj.label.empty()) {
-        sf::Text text(font, obj.label, 12);
-        text.setFillColor(sf::Color::White);
-        text.setPosition({obj.position.x - 20, obj.position.y - obj.radius - 20});
-        window.draw(text);
+    renderLabels(bodies, positions);
+}
+
+void Renderer::fillBodies(const BodyStorage& bodies, const AlignedVector<Vector2D>& positions, size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+        const BodyAppearance& look = bodies.appearance[i];
+        sf::Color color(
+            static_cast<std::uint8_t>(look.colorR * 255),
+            static_cast<std::uint8_t>(look.colorG * 255),
+            static_cast<std::uint8_t>(look.colorB * 255)
+        );
+        
+        // Dimmer color for static objects
+        if (bodies.motion[i] == BodyMotion::Static) {
+            color = sf::Color(color.r / 2, color.g / 2, color.b / 2);
+        } else if (bodies.motion[i] == BodyMotion::Sleeping) {
+            color = sf::Color(color.r * 3 / 4, color.g * 3 / 4, color.b * 3 / 4);
+        }
+        
+        // White outline quad first, the body on top of it
+        sf::Vertex* v = &bodyVertices[i * kVerticesPerBody];
+        const Vector2D& position = positions[i];
+        if (bodies.shape[i] == ShapeType::Circle) {
+            float radius = bodies.radius[i];
+            float outer = radius + kOutlineThickness;
+            putQuad(v, position, outer, outer, sf::Color::White, true);
+            putQuad(v + kVerticesPerQuad, position, radius, radius, color, true);
+        } else {
+            Vector2D half = bodies.extents[i] * 0.5f;
+            putQuad(v, position, half.x + kOutlineThickness, half.y + kOutlineThickness, sf::Color::White, false);
+            putQuad(v + kVerticesPerQuad, position, half.x, half.y, color, false);
+        }
     }
 }
 
-void Renderer::renderVectors(const PhysicsObject& obj, bool showVelocity, bool showForce) {
-    if (obj.isStatic) return;
-    
-    Vector2D start = obj.position;
-    
-    // Velocity vector (green)
-    if (showVelocity && obj.velocity.magnitude() > 0.1f) {
-        Vector2D end = start + obj.velocity * vectorScale;
-        drawArrow(start, end, sf::Color::Green);
+void Renderer::fillVectors(const BodyStorage& bodies, const AlignedVector<Vector2D>& positions, size_t begin, size_t end) {
+    const size_t arrowsPerBody = (showVelocityVectors ? 1 : 0) + (showForceVectors ? 1 : 0);
+    for (size_t i = begin; i < end; ++i) {
+        sf::Vertex* v = &vectorVertices[i * arrowsPerBody * kVerticesPerArrow];
+        const Vector2D& start = positions[i];
+        bool isStatic = bodies.motion[i] == BodyMotion::Static;
+        
+        // Velocity vector (green)
+        if (showVelocityVectors) {
+            const Vector2D& velocity = bodies.velocity[i];
+            if (!isStatic && velocity.magnitude() > 0.1f) {
+                putArrow(v, start, start + velocity * vectorScale, sf::Color::Green);
+            } else {
+                putEmptyArrow(v, start);
+            }
+            v += kVerticesPerArrow;
+        }
+        
+        // Force vector (red)
+        if (showForceVectors) {
+            const Vector2D& force = bodies.force[i];
+            if (!isStatic && force.magnitude() > 0.1f) {
+                putArrow(v, start, start + force * vectorScale * 0.01f, sf::Color::Red);
+            } else {
+                putEmptyArrow(v, start);
+            }
+        }
     }
+}
+
+void Renderer::renderLabels(const BodyStorage& bodies, const AlignedVector<Vector2D>& positions) {
+    if (!showLabels || !fontLoaded) return;
     
-    // Force vector (red)
-    if (showForce && obj.forceAccumulator.magnitude() > 0.1f) {
-        Vector2D end = start + obj.forceAccumulator * vectorScale * 0.01f;
-        drawArrow(start, end, sf::Color::Red);
+    labels.begin();
+    for (size_t i = 0; i < bodies.size(); ++i) {
+        const std::string& label = bodies.appearance[i].label;
+        if (label.empty()) continue;
+        
+        const Vector2D& position = positions[i];
+        labels.add(label, {position.x - 20, position.y - bodies.radius[i] - 20}, sf::Color::White);
     }
+    labels.draw(window);
 }
 
 void Renderer::renderTrajectory(const std::vector<Vector2D>& trail) {
@@ -84,70 +224,81 @@ void Renderer::renderTrajectory(const std::vector<Vector2D>& trail) {
     window.draw(lines);
 }
 
+void Renderer::renderPrediction(const AlignedVector<Vector2D>& path) {
+    if (path.size() < 2) return;
+    
+    // A fading line through every point and a dot on every third, each
+    // one draw call
+    constexpr size_t kPointsPerDot = 3;
+    constexpr float kDotRadius = 3.0f;
+    const size_t count = path.size();
+    predictionLine.resize(count);
+    predictionDots.resize((count + kPointsPerDot - 1) / kPointsPerDot * kVerticesPerQuad);
+    for (size_t i = 0; i < count; ++i) {
+        const Vector2D& point = path[i];
+        predictionLine[i] = sf::Vertex{{point.x, point.y},
+                                       sf::Color(255, 220, 100, static_cast<std::uint8_t>(180 - i * 120 / count))};
+        if (i % kPointsPerDot == 0) {
+            sf::Color color(255, 255, 100, static_cast<std::uint8_t>(200 - i * 150 / count));
+            putQuad(&predictionDots[i / kPointsPerDot * kVerticesPerQuad], point, kDotRadius, kDotRadius, color, true);
+        }
+    }
+    window.draw(predictionLine);
+    window.draw(predictionDots, sf::RenderStates(&shapeTexture));
+}
+
 void Renderer::renderGrid(float spacing) {
-    sf::Vector2u size = window.getSize();
-    sf::Color gridColor(50, 50, 50);
+    if (spacing <= 0.0f) return;
     
-    // Vertical lines
-    for (float x = 0; x < size.x; x += spacing) {
-        sf::Vertex line[] = {
-            sf::Vertex{{x, 0}, gridColor},
-            sf::Vertex{{x, static_cast<float>(size.y)}, gridColor}
-        };
-        window.draw(line, 2, sf::PrimitiveType::Lines);
+    const sf::View& view = window.getView();
+    sf::Vector2f viewSize = view.getSize();
+    if (viewSize.x <= 0.0f || viewSize.y <= 0.0f) return;
+    
+    float pixelsPerUnit = static_cast<float>(window.getSize().x) / viewSize.x;
+    float step = spacing;
+    while (step * pixelsPerUnit < minGridPixels) {
+        step *= 2.0f;
     }
     
-    // Horizontal lines
-    for (float y = 0; y < size.y; y += spacing) {
-        sf::Vertex line[] = {
-            sf::Vertex{{0, y}, gridColor},
-            sf::Vertex{{static_cast<float>(size.x), y}, gridColor}
-        };
-        window.draw(line, 2, sf::PrimitiveType::Lines);
+    if (step != gridStep || viewSize.x != gridViewSize.x || viewSize.y != gridViewSize.y) {
+        rebuildGrid(step, viewSize);
     }
-}
-
-void Renderer::drawArrow(const Vector2D& start, const Vector2D& end, const sf::Color& color) {
-    // Draw line
-    sf::Vertex line[] = {
-        sf::Vertex{{start.x, start.y}, color},
-        sf::Vertex{{end.x, end.y}, color}
-    };
-    window.draw(line, 2, sf::PrimitiveType::Lines);
     
-    // Draw arrowhead
-    Vector2D direction = (end - start).normalized();
-    Vector2D perpendicular(-direction.y, direction.x);
+    // The grid repeats every cell, so panning only shifts it by whole cells
+    sf::Vector2f topLeft = view.getCenter() - viewSize * 0.5f;
+    sf::RenderStates states;
+    states.transform.translate({std::floor(topLeft.x / step) * step, std::floor(topLeft.y / step) * step});
     
-    float arrowSize = 8.0f;
-    Vector2D tip = end;
-    Vector2D left = tip - direction * arrowSize + perpendicular * (arrowSize * 0.5f);
-    Vector2D right = tip - direction * arrowSize - perpendicular * (arrowSize * 0.5f);
-    
-    sf::ConvexShape arrow(3);
-    arrow.setPoint(0, {tip.x, tip.y});
-    arrow.setPoint(1, {left.x, left.y});
-    arrow.setPoint(2, {right.x, right.y});
-    arrow.setFillColor(color);
-    window.draw(arrow);
-}
-
-void Renderer::drawCircle(const Vector2D& position, float radius, const sf::Color& color) {
-    sf::CircleShape circle(radius);
-    circle.setPosition({position.x - radius, position.y - radius});
-    circle.setFillColor(color);
-    circle.setOutlineColor(sf::Color::White);
-    circle.setOutlineThickness(2.0f);
-    window.draw(circle);
+    if (gridBuffered) {
+        window.draw(gridBuffer, states);
+    } else {
+        window.draw(gridVertices.data(), gridVertices.size(), sf::PrimitiveType::Lines, states);
+    }
 }
 
-void Renderer::drawBox(const Vector2D& position, float width, float height, const sf::Color& color) {
-    sf::RectangleShape box(sf::Vector2f(width, height));
-    box.setPosition({position.x - width / 2, position.y - height / 2});
-    box.setFillColor(color);
-    box.setOutlineColor(sf::Color::White);
-    box.setOutlineThickness(2.0f);
-    window.draw(box);
+void Renderer::rebuildGrid(float step, sf::Vector2f viewSize) {
+    gridStep = step;
+    gridViewSize = viewSize;
+    
+    sf::Color gridColor(50, 50, 50);
+    float width = viewSize.x + step;
+    float height = viewSize.y + step;
+    
+    gridVertices.clear();
+    // Vertical lines
+    for (float x = 0; x <= width; x += step) {
+        gridVertices.push_back(sf::Vertex{{x, 0}, gridColor});
+        gridVertices.push_back(sf::Vertex{{x, height}, gridColor});
+    }
+    // Horizontal lines
+    for (float y = 0; y <= height; y += step) {
+        gridVertices.push_back(sf::Vertex{{0, y}, gridColor});
+        gridVertices.push_back(sf::Vertex{{width, y}, gridColor});
+    }
+    
+    // Without vertex buffer support the lines are drawn from memory instead
+    gridBuffered = sf::VertexBuffer::isAvailable() && gridBuffer.create(gridVertices.size()) &&
+                   gridBuffer.update(gridVertices.data());
 }
 
 } // namespace Physica
@@ -1,8 +1,8 @@
 #pragma once
 #include "PhysicsObject.h"
 #include "PhysicsEngine.h"
+#include "LabelLayer.h"
 #include <SFML/Graphics.hpp>
-#include <memory>
 #include <vector>
 
 namespace Physica {
@@ -11,10 +11,19 @@ class Renderer {
 public:
     Renderer(sf::RenderWindow& window);
     
-    void render(const std::vector<std::shared_ptr<PhysicsObject>>& objects);
-    void renderObject(const PhysicsObject& obj);
-    void renderVectors(const PhysicsObject& obj, bool showVelocity, bool showForce);
+    // Draws every body, then the velocity and force vectors, then labels.
+    // Bodies and vectors are each one batched draw call. `positions`
+    // overrides bodies.position (e.g. interpolated between steps).
+    void render(const BodyStorage& bodies) { render(bodies, bodies.position); }
+    void render(const BodyStorage& bodies, const AlignedVector<Vector2D>& positions);
     void renderTrajectory(const std::vector<Vector2D>& trail);
+    // A predicted path (TrajectoryPredictor) as a line with dots along it
+    void renderPrediction(const AlignedVector<Vector2D>& path);
+    // Grid lines `spacing` apart in world units, in the window's current
+    // view. The lines are built once into a GPU buffer and only rebuilt
+    // when the view size (window size or zoom) or the spacing changes;
+    // panning just moves them. When zoomed far out, the spacing doubles
+    // until lines are at least minGridPixels apart on screen.
     void renderGrid(float spacing);
     
     // Settings
@@ -23,15 +32,39 @@ public:
     bool showLabels = true;
     bool showGrid = false;
     float vectorScale = 0.1f;
+    float gridSpacing = 50.0f;
+    float minGridPixels = 8.0f;
     
 private:
     sf::RenderWindow& window;
     sf::Font font;
     bool fontLoaded;
+    LabelLayer labels;
     
-    void drawArrow(const Vector2D& start, const Vector2D& end, const sf::Color& color);
-    void drawCircle(const Vector2D& position, float radius, const sf::Color& color);
-    void drawBox(const Vector2D& position, float width, float height, const sf::Color& color);
+    // Batched geometry, refilled every frame in parallel chunks on a small
+    // pool of its own, so filling leaves the cores to the physics step. Every
+    // shape is a textured quad (two triangles) or triangle sampling one
+    // texture: an anti-aliased disc for circles and a solid white square
+    // for everything else. The arrays keep their capacity between frames.
+    sf::Texture shapeTexture;
+    sf::VertexArray bodyVertices;
+    sf::VertexArray vectorVertices;
+    sf::VertexArray predictionLine;
+    sf::VertexArray predictionDots;
+    ThreadPool fillPool;
+    
+    // Grid covering one view plus one cell, drawn shifted by whole cells
+    std::vector<sf::Vertex> gridVertices;
+    sf::VertexBuffer gridBuffer;
+    bool gridBuffered = false;
+    float gridStep = 0.0f;
+    sf::Vector2f gridViewSize;
+    
+    void buildShapeTexture();
+    void rebuildGrid(float step, sf::Vector2f viewSize);
+    void fillBodies(const BodyStorage& bodies, const AlignedVector<Vector2D>& positions, size_t begin, size_t end);
+    void fillVectors(const BodyStorage& bodies, const AlignedVector<Vector2D>& positions, size_t begin, size_t end);
+    void renderLabels(const BodyStorage& bodies, const AlignedVector<Vector2D>& positions);
 };
 
 } // namespace Physica
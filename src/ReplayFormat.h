@@ -0,0 +1,107 @@
+#pragma once
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace Physica {
+
+// Replay files: a ReplayFileHeader, then one record per recorded step.
+// Each record is a ReplayRecordHeader followed by its payload.
+//
+// Keyframe payload: body count, then per body its shape, motion, radius,
+// extents, color and label, then every position as an absolute quantized
+// value. Delta payload (same bodies as the previous record): the bodies
+// whose motion changed, then per body the quantized position minus a
+// prediction from the previous two frames (the previous frame alone right
+// after a keyframe). Integers are zigzag LEB128 varints, so a body moving
+// smoothly costs one or two bytes per axis.
+
+constexpr char kReplayMagic[8] = {'P', 'H', 'Y', 'R', 'E', 'P', 'L', '\0'};
+constexpr std::uint32_t kReplayVersion = 1;
+constexpr std::uint32_t kReplayByteOrderMark = 0x01020304;
+
+struct ReplayFileHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t byteOrder;
+    float precision;  // World units per quantization step
+    float timeStep;   // Seconds between records
+    std::uint32_t keyframeInterval;
+    std::uint32_t reserved;
+};
+static_assert(sizeof(ReplayFileHeader) == 32, "replay header layout changed");
+
+enum ReplayRecordType : std::uint32_t {
+    kReplayKeyframe = 1,
+    kReplayDelta = 2
+};
+
+struct ReplayRecordHeader {
+    std::uint32_t type;  // ReplayRecordType
+    std::uint32_t size;  // Payload bytes
+    std::uint64_t step;  // Engine step count of the frame
+};
+static_assert(sizeof(ReplayRecordHeader) == 16, "replay record header layout changed");
+
+inline std::int64_t quantizeReplay(float value, float precision) {
+    double scaled = static_cast<double>(value) / precision;
+    return std::isfinite(scaled) ? std::llround(scaled) : 0;
+}
+
+inline void putReplayVarint(std::vector<std::uint8_t>& out, std::uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<std::uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<std::uint8_t>(value));
+}
+
+inline void putReplaySigned(std::vector<std::uint8_t>& out, std::int64_t value) {
+    putReplayVarint(out, (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63));
+}
+
+template <typename T>
+void putReplayRaw(std::vector<std::uint8_t>& out, const T& value) {
+    const std::uint8_t* bytes = reinterpret_cast<const std::uint8_t*>(&value);
+    out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+
+// Bounds-checked reads from a record payload; any overrun sets `failed`
+struct ReplayPayloadReader {
+    const std::uint8_t* data;
+    size_t size;
+    size_t offset = 0;
+    bool failed = false;
+
+    std::uint64_t varint() {
+        std::uint64_t value = 0;
+        for (int shift = 0; shift < 64 && offset < size; shift += 7) {
+            std::uint8_t byte = data[offset++];
+            value |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+            if (!(byte & 0x80)) return value;
+        }
+        failed = true;
+        return 0;
+    }
+
+    std::int64_t signedVarint() {
+        std::uint64_t value = varint();
+        return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1);
+    }
+
+    template <typename T>
+    T raw() {
+        T value{};
+        if (offset > size || size - offset < sizeof(T)) {
+            failed = true;
+            return value;
+        }
+        std::memcpy(&value, data + offset, sizeof(T));
+        offset += sizeof(T);
+        return value;
+    }
+};
+
+} // namespace Physica
@@ -0,0 +1,166 @@
+#include "ReplayPlayer.h"
+#include "ReplayFormat.h"
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+
+namespace Physica {
+
+bool ReplayPlayer::open(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return false;
+    std::vector<std::uint8_t> contents((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+    ReplayFileHeader header;
+    if (contents.size() < sizeof(header)) return false;
+    std::memcpy(&header, contents.data(), sizeof(header));
+    if (std::memcmp(header.magic, kReplayMagic, sizeof(kReplayMagic)) != 0 || header.version != kReplayVersion ||
+        header.byteOrder != kReplayByteOrderMark || !(header.precision > 0.0f) || !(header.timeStep > 0.0f)) {
+        return false;
+    }
+
+    // A recording cut off mid-write keeps every complete record
+    std::vector<Record> index;
+    std::vector<size_t> keys;
+    size_t offset = sizeof(header);
+    while (contents.size() - offset >= sizeof(ReplayRecordHeader)) {
+        ReplayRecordHeader record;
+        std::memcpy(&record, contents.data() + offset, sizeof(record));
+        offset += sizeof(record);
+        if (record.type != kReplayKeyframe && record.type != kReplayDelta) return false;
+        if (contents.size() - offset < record.size) break;
+        if (record.type == kReplayKeyframe) keys.push_back(index.size());
+        index.push_back({offset, record.size, record.step, record.type == kReplayKeyframe});
+        offset += record.size;
+    }
+    if (keys.empty()) return false;
+
+    data.swap(contents);
+    records.swap(index);
+    keyframes.swap(keys);
+    precision = header.precision;
+    timeStep = header.timeStep;
+    current = -1;
+    bodies.clear();
+    return seek(0) || seek(keyframes.front());
+}
+
+size_t ReplayPlayer::getKeyframe() const {
+    auto it = std::upper_bound(keyframes.begin(), keyframes.end(), static_cast<size_t>(std::max<std::int64_t>(current, 0)));
+    return it == keyframes.begin() ? 0 : static_cast<size_t>(it - keyframes.begin()) - 1;
+}
+
+bool ReplayPlayer::seek(size_t frame) {
+    if (frame >= records.size()) return false;
+
+    // Decode forward from the current frame when no keyframe lies between
+    size_t start = frame;
+    auto it = std::upper_bound(keyframes.begin(), keyframes.end(), frame);
+    if (it == keyframes.begin()) return false;
+    size_t keyframe = *(it - 1);
+    if (current >= 0 && static_cast<size_t>(current) >= keyframe && static_cast<size_t>(current) < frame) {
+        start = static_cast<size_t>(current) + 1;
+    } else {
+        start = keyframe;
+    }
+
+    for (size_t i = start; i <= frame; ++i) {
+        if (!decode(i)) {
+            current = -1;
+            bodies.clear();
+            return false;
+        }
+    }
+    current = static_cast<std::int64_t>(frame);
+    updatePositions();
+    return true;
+}
+
+bool ReplayPlayer::seekKeyframe(size_t keyframe) {
+    return keyframe < keyframes.size() && seek(keyframes[keyframe]);
+}
+
+bool ReplayPlayer::next() {
+    return current >= 0 && seek(static_cast<size_t>(current) + 1);
+}
+
+bool ReplayPlayer::decode(size_t frame) {
+    const Record& record = records[frame];
+    return record.keyframe ? decodeKeyframe(record) : decodeDelta(record);
+}
+
+bool ReplayPlayer::decodeKeyframe(const Record& record) {
+    ReplayPayloadReader reader{data.data() + record.offset, record.size};
+    const std::uint64_t count = reader.varint();
+    // Every body takes at least 27 bytes, which bounds a corrupt count
+    if (reader.failed || count > record.size / 27) return false;
+
+    bodies.clear();
+    bodies.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        std::uint8_t shape = reader.raw<std::uint8_t>();
+        std::uint8_t motion = reader.raw<std::uint8_t>();
+        if (shape > static_cast<std::uint8_t>(ShapeType::Box) || motion > static_cast<std::uint8_t>(BodyMotion::Sleeping)) {
+            return false;
+        }
+        PhysicsObject object(Vector2D(), 1.0f, static_cast<ShapeType>(shape));
+        object.radius = reader.raw<float>();
+        Vector2D extents = reader.raw<Vector2D>();
+        object.width = extents.x;
+        object.height = extents.y;
+        object.isStatic = static_cast<BodyMotion>(motion) == BodyMotion::Static;
+        object.colorR = reader.raw<float>();
+        object.colorG = reader.raw<float>();
+        object.colorB = reader.raw<float>();
+        std::uint64_t length = reader.varint();
+        if (reader.failed || length > record.size - reader.offset) return false;
+        object.label.assign(reinterpret_cast<const char*>(reader.data + reader.offset), length);
+        reader.offset += length;
+        bodies.add(object);
+        bodies.motion[i] = static_cast<BodyMotion>(motion);
+    }
+
+    previous.resize(count * 2);
+    for (size_t k = 0; k < count * 2; ++k) {
+        previous[k] = reader.signedVarint();
+    }
+    beforePrevious = previous;
+    havePreviousTwo = false;
+    return !reader.failed;
+}
+
+bool ReplayPlayer::decodeDelta(const Record& record) {
+    ReplayPayloadReader reader{data.data() + record.offset, record.size};
+    const size_t count = bodies.size();
+    if (previous.size() != count * 2) return false;
+
+    const std::uint64_t changes = reader.varint();
+    for (std::uint64_t c = 0; c < changes && !reader.failed; ++c) {
+        std::uint64_t i = reader.varint();
+        std::uint8_t motion = reader.raw<std::uint8_t>();
+        if (i >= count || motion > static_cast<std::uint8_t>(BodyMotion::Sleeping)) return false;
+        bodies.motion[i] = static_cast<BodyMotion>(motion);
+    }
+
+    // Mirrors ReplayRecorder::encode
+    for (size_t k = 0; k < count * 2; ++k) {
+        const std::int64_t predicted = havePreviousTwo ? 2 * previous[k] - beforePrevious[k] : previous[k];
+        beforePrevious[k] = predicted + reader.signedVarint();
+    }
+    previous.swap(beforePrevious);
+    havePreviousTwo = true;
+    return !reader.failed;
+}
+
+void ReplayPlayer::updatePositions() {
+    // Right after a keyframe beforePrevious equals previous, so velocity is zero
+    for (size_t i = 0; i < bodies.size(); ++i) {
+        Vector2D now(previous[i * 2] * precision, previous[i * 2 + 1] * precision);
+        Vector2D before(beforePrevious[i * 2] * precision, beforePrevious[i * 2 + 1] * precision);
+        bodies.position[i] = now;
+        bodies.previousPosition[i] = before;
+        bodies.velocity[i] = (now - before) / timeStep;
+    }
+}
+
+} // namespace Physica
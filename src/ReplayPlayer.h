@@ -0,0 +1,61 @@
+#pragma once
+#include "BodyStorage.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Physica {
+
+// Plays back a file written by ReplayRecorder without a PhysicsEngine.
+// open() loads the file and indexes its records; seek() decodes forward
+// from the nearest keyframe at or before the requested frame. getBodies()
+// holds the decoded frame with positions, motion, shapes and colors set
+// and velocity estimated from the last two frames, which is enough for
+// Renderer. Masses and other simulation-only fields are not recorded.
+class ReplayPlayer {
+public:
+    bool open(const std::string& path);
+
+    size_t getFrameCount() const { return records.size(); }
+    size_t getKeyframeCount() const { return keyframes.size(); }
+    float getTimeStep() const { return timeStep; }
+
+    // Current frame, -1 before the first successful seek
+    std::int64_t getFrame() const { return current; }
+    std::uint64_t getStep() const { return current < 0 ? 0 : records[current].step; }
+    // Keyframe at or before the current frame
+    size_t getKeyframe() const;
+
+    bool seek(size_t frame);
+    bool seekKeyframe(size_t keyframe);
+    bool next();  // Advance one frame; false at the end
+
+    const BodyStorage& getBodies() const { return bodies; }
+
+private:
+    struct Record {
+        size_t offset;  // Payload position in data
+        std::uint32_t size;
+        std::uint64_t step;
+        bool keyframe;
+    };
+
+    std::vector<std::uint8_t> data;
+    std::vector<Record> records;
+    std::vector<size_t> keyframes;  // Record indices
+    float precision = 1.0f;
+    float timeStep = 1.0f / 60.0f;
+
+    std::int64_t current = -1;
+    BodyStorage bodies;
+    std::vector<std::int64_t> previous;  // Quantized x, y of the last two frames
+    std::vector<std::int64_t> beforePrevious;
+    bool havePreviousTwo = false;
+
+    bool decode(size_t frame);
+    bool decodeKeyframe(const Record& record);
+    bool decodeDelta(const Record& record);
+    void updatePositions();
+};
+
+} // namespace Physica
@@ -0,0 +1,182 @@
+#include "ReplayRecorder.h"
+#include "ReplayFormat.h"
+#include <algorithm>
+#include <chrono>
+
+namespace Physica {
+
+ReplayRecorder::ReplayRecorder(size_t queueFrames)
+    : slots(std::max<size_t>(queueFrames, 2)) {
+}
+
+ReplayRecorder::~ReplayRecorder() {
+    stop();
+}
+
+bool ReplayRecorder::start(const std::string& path, float timeStep) {
+    stop();
+    file = std::fopen(path.c_str(), "wb");
+    if (!file) return false;
+
+    ReplayFileHeader header = {};
+    std::memcpy(header.magic, kReplayMagic, sizeof(kReplayMagic));
+    header.version = kReplayVersion;
+    header.byteOrder = kReplayByteOrderMark;
+    header.precision = precision;
+    header.timeStep = timeStep;
+    header.keyframeInterval = keyframeInterval;
+    if (std::fwrite(&header, sizeof(header), 1, file) != 1) {
+        std::fclose(file);
+        file = nullptr;
+        return false;
+    }
+
+    writerPrecision = precision;
+    writeIndex.store(0, std::memory_order_relaxed);
+    readIndex.store(0, std::memory_order_relaxed);
+    framesWritten.store(0, std::memory_order_relaxed);
+    bytesWritten.store(sizeof(header), std::memory_order_relaxed);
+    droppedFrames.store(0, std::memory_order_relaxed);
+    needKeyframe = true;
+    stopping = false;
+    recording = true;
+    writer = std::thread([this] { writerLoop(); });
+    return true;
+}
+
+void ReplayRecorder::stop() {
+    if (!recording) return;
+    recording = false;
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        stopping = true;
+    }
+    wakeCondition.notify_one();
+    writer.join();
+    std::fclose(file);
+    file = nullptr;
+}
+
+void ReplayRecorder::record(const BodyStorage& bodies, std::uint64_t step) {
+    if (!recording) return;
+
+    const size_t index = writeIndex.load(std::memory_order_relaxed);
+    if (index - readIndex.load(std::memory_order_acquire) == slots.size()) {
+        // Never wait for the disk: drop the frame and restart the deltas
+        droppedFrames.fetch_add(1, std::memory_order_relaxed);
+        needKeyframe = true;
+        return;
+    }
+
+    Frame& frame = slots[index % slots.size()];
+    frame.step = step;
+    frame.keyframe = needKeyframe || framesSinceKeyframe + 1 >= keyframeInterval || bodies.size() != lastBodyCount;
+    frame.position = bodies.position;
+    frame.motion = bodies.motion;
+    if (frame.keyframe) {
+        frame.shape = bodies.shape;
+        frame.radius = bodies.radius;
+        frame.extents = bodies.extents;
+        frame.appearance = bodies.appearance;
+        framesSinceKeyframe = 0;
+        needKeyframe = false;
+    } else {
+        ++framesSinceKeyframe;
+    }
+    lastBodyCount = bodies.size();
+
+    writeIndex.store(index + 1, std::memory_order_release);
+    // The writer polls every few milliseconds anyway; waking it for every
+    // frame would switch threads mid-step when cores are scarce
+    if (index + 1 - readIndex.load(std::memory_order_relaxed) >= slots.size() / 2) {
+        wakeCondition.notify_one();
+    }
+}
+
+void ReplayRecorder::writerLoop() {
+    while (true) {
+        const size_t index = readIndex.load(std::memory_order_relaxed);
+        if (index == writeIndex.load(std::memory_order_acquire)) {
+            std::unique_lock<std::mutex> lock(wakeMutex);
+            if (stopping && index == writeIndex.load(std::memory_order_acquire)) break;
+            // record() only notifies when the ring fills up, and without
+            // taking the mutex, so poll as well
+            wakeCondition.wait_for(lock, std::chrono::milliseconds(5));
+            continue;
+        }
+
+        const Frame& frame = slots[index % slots.size()];
+        encode(frame);
+        ReplayRecordHeader header;
+        header.type = frame.keyframe ? kReplayKeyframe : kReplayDelta;
+        header.size = static_cast<std::uint32_t>(payload.size());
+        header.step = frame.step;
+        // The slot is free for record() from here on
+        readIndex.store(index + 1, std::memory_order_release);
+
+        std::fwrite(&header, sizeof(header), 1, file);
+        std::fwrite(payload.data(), 1, payload.size(), file);
+        framesWritten.fetch_add(1, std::memory_order_relaxed);
+        bytesWritten.fetch_add(sizeof(header) + payload.size(), std::memory_order_relaxed);
+    }
+    std::fflush(file);
+}
+
+void ReplayRecorder::encode(const Frame& frame) {
+    const size_t count = frame.position.size();
+    payload.clear();
+
+    if (frame.keyframe) {
+        putReplayVarint(payload, count);
+        for (size_t i = 0; i < count; ++i) {
+            const BodyAppearance& look = frame.appearance[i];
+            putReplayRaw(payload, static_cast<std::uint8_t>(frame.shape[i]));
+            putReplayRaw(payload, static_cast<std::uint8_t>(frame.motion[i]));
+            putReplayRaw(payload, frame.radius[i]);
+            putReplayRaw(payload, frame.extents[i]);
+            putReplayRaw(payload, look.colorR);
+            putReplayRaw(payload, look.colorG);
+            putReplayRaw(payload, look.colorB);
+            putReplayVarint(payload, look.label.size());
+            payload.insert(payload.end(), look.label.begin(), look.label.end());
+        }
+        previous.resize(count * 2);
+        for (size_t i = 0; i < count; ++i) {
+            previous[i * 2] = quantizeReplay(frame.position[i].x, writerPrecision);
+            previous[i * 2 + 1] = quantizeReplay(frame.position[i].y, writerPrecision);
+            putReplaySigned(payload, previous[i * 2]);
+            putReplaySigned(payload, previous[i * 2 + 1]);
+        }
+        previousMotion.assign(frame.motion.begin(), frame.motion.end());
+        havePreviousTwo = false;
+        return;
+    }
+
+    // Motion changes (bodies falling asleep or waking) as a sparse list
+    size_t changes = 0;
+    for (size_t i = 0; i < count; ++i) {
+        changes += frame.motion[i] != previousMotion[i];
+    }
+    putReplayVarint(payload, changes);
+    for (size_t i = 0; i < count && changes > 0; ++i) {
+        if (frame.motion[i] == previousMotion[i]) continue;
+        putReplayVarint(payload, i);
+        putReplayRaw(payload, static_cast<std::uint8_t>(frame.motion[i]));
+        previousMotion[i] = frame.motion[i];
+    }
+
+    // Residuals against a constant velocity prediction; the rotation
+    // leaves this frame in `previous` and the last one in `beforePrevious`
+    beforePrevious.resize(count * 2);
+    for (size_t k = 0; k < count * 2; ++k) {
+        const float value = (k & 1) ? frame.position[k / 2].y : frame.position[k / 2].x;
+        const std::int64_t q = quantizeReplay(value, writerPrecision);
+        const std::int64_t predicted = havePreviousTwo ? 2 * previous[k] - beforePrevious[k] : previous[k];
+        putReplaySigned(payload, q - predicted);
+        beforePrevious[k] = q;
+    }
+    previous.swap(beforePrevious);
+    havePreviousTwo = true;
+}
+
+} // namespace Physica
@@ -0,0 +1,90 @@
+#pragma once
+#include "BodyStorage.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Physica {
+
+// Records body positions every step to a replay file (see ReplayFormat.h)
+// without slowing the step loop. record() only copies positions and
+// motion into a slot of a bounded ring; a background thread quantizes,
+// delta-encodes and writes them. When the writer falls behind and the ring
+// is full, the frame is dropped and the next one becomes a keyframe.
+// Keyframes also carry shapes, colors and labels; they are written every
+// keyframeInterval frames and whenever the body count changes.
+// Once the slots have grown to the body count, recording does not
+// allocate. start(), stop() and record() must be called from one thread.
+class ReplayRecorder {
+public:
+    explicit ReplayRecorder(size_t queueFrames = 16);
+    ~ReplayRecorder();
+
+    ReplayRecorder(const ReplayRecorder&) = delete;
+    ReplayRecorder& operator=(const ReplayRecorder&) = delete;
+
+    bool start(const std::string& path, float timeStep);
+    void stop();  // Writes out every queued frame and closes the file
+    bool isRecording() const { return recording; }
+
+    void record(const BodyStorage& bodies, std::uint64_t step);
+
+    // Writer statistics, safe to read while recording
+    std::uint64_t getFramesWritten() const { return framesWritten.load(std::memory_order_relaxed); }
+    std::uint64_t getBytesWritten() const { return bytesWritten.load(std::memory_order_relaxed); }
+    std::uint64_t getDroppedFrames() const { return droppedFrames.load(std::memory_order_relaxed); }
+
+    // Settings, read by start()
+    float precision = 1.0f / 64.0f;  // World units per quantization step
+    std::uint32_t keyframeInterval = 120;
+
+private:
+    struct Frame {
+        std::uint64_t step = 0;
+        bool keyframe = false;
+        AlignedVector<Vector2D> position;
+        AlignedVector<BodyMotion> motion;
+        // Keyframes only
+        AlignedVector<ShapeType> shape;
+        AlignedVector<float> radius;
+        AlignedVector<Vector2D> extents;
+        std::vector<BodyAppearance> appearance;
+    };
+
+    std::vector<Frame> slots;
+    alignas(kCacheLineSize) std::atomic<size_t> writeIndex{0};  // Next slot record() fills
+    alignas(kCacheLineSize) std::atomic<size_t> readIndex{0};   // Next slot the writer encodes
+
+    // Recording thread state
+    bool recording = false;
+    bool needKeyframe = true;
+    std::uint32_t framesSinceKeyframe = 0;
+    size_t lastBodyCount = 0;
+
+    // Writer thread state
+    std::thread writer;
+    std::mutex wakeMutex;
+    std::condition_variable wakeCondition;
+    bool stopping = false;
+    std::FILE* file = nullptr;
+    float writerPrecision = 1.0f;
+    std::vector<std::uint8_t> payload;
+    std::vector<std::int64_t> previous;  // Quantized x, y of the last two frames
+    std::vector<std::int64_t> beforePrevious;
+    std::vector<BodyMotion> previousMotion;
+    bool havePreviousTwo = false;
+
+    std::atomic<std::uint64_t> framesWritten{0};
+    std::atomic<std::uint64_t> bytesWritten{0};
+    std::atomic<std::uint64_t> droppedFrames{0};
+
+    void writerLoop();
+    void encode(const Frame& frame);
+};
+
+} // namespace Physica
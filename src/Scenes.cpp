@@ -0,0 +1,45 @@
+#include "Scenes.h"
+
+namespace Physica {
+
+void addProjectileMotionScene(PhysicsEngine& engine) {
+    PhysicsObject obj(Vector2D(100, 600), 10.0f);
+    obj.velocity = Vector2D(300, -400);
+    obj.colorR = 1.0f;
+    obj.colorG = 0.5f;
+    obj.colorB = 0.0f;
+    engine.addObject(obj);
+}
+
+void addElasticCollisionsScene(PhysicsEngine& engine) {
+    PhysicsObject obj1(Vector2D(300, 360), 15.0f);
+    obj1.velocity = Vector2D(200, 0);
+    obj1.restitution = 1.0f;
+    obj1.colorR = 0.2f;
+    obj1.colorG = 0.8f;
+    obj1.colorB = 1.0f;
+    engine.addObject(obj1);
+
+    PhysicsObject obj2(Vector2D(800, 360), 15.0f);
+    obj2.velocity = Vector2D(-200, 0);
+    obj2.restitution = 1.0f;
+    obj2.colorR = 1.0f;
+    obj2.colorG = 0.3f;
+    obj2.colorB = 0.3f;
+    engine.addObject(obj2);
+}
+
+void addHarmonicMotionScene(PhysicsEngine& engine) {
+    // Stiffness (2 pi / period)^2 for a 2 s period
+    const float pi = 3.14159265f;
+    SpringField spring;
+    spring.anchor = Vector2D(640, 260);
+    spring.stiffness = pi * pi;
+    engine.addForceField(spring);
+
+    PhysicsObject obj(Vector2D(640, 200), 10.0f);
+    obj.velocity = Vector2D(200, 0);
+    engine.addObject(obj);
+}
+
+} // namespace Physica
@@ -0,0 +1,20 @@
+#pragma once
+#include "PhysicsEngine.h"
+
+namespace Physica {
+
+// Starting worlds of the educational modules, added to whatever the engine
+// already holds. The app loads them into its modules and the integrator
+// benchmark steps them headless, so both run the same bodies.
+
+// One body launched up and to the right
+void addProjectileMotionScene(PhysicsEngine& engine);
+
+// Two equal, perfectly elastic bodies meeting head on
+void addElasticCollisionsScene(PhysicsEngine& engine);
+
+// A body on a spring (a SpringField), oscillating with a 2 s period about
+// the point where the spring balances gravity
+void addHarmonicMotionScene(PhysicsEngine& engine);
+
+} // namespace Physica
@@ -0,0 +1,103 @@
+#include "SimdKernels.h"
+#include "CpuFeatures.h"
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+namespace Physica {
+
+namespace {
+
+// Reference versions of the batch kernels. The SIMD kernels mirror these
+// operation for operation, so results match bit for bit.
+struct ScalarKernels {
+    template <IntegrationMethod Method, bool Gravity, bool Drag>
+    static void step(const BodyBatch& batch, const ForceParams& params, float dt) {
+        for (size_t i = 0; i < batch.count; ++i) {
+            const float invMass = batch.invMass[i];
+            if (invMass == 0.0f) continue;
+
+            const Vector2D v = batch.velocity[i];
+            const Vector2D f = addBuiltInForces(batch.force[i], v, batch.mass[i], batch.friction[i], params,
+                                                Gravity, Drag);
+            const Vector2D acceleration = f * invMass;
+            const Vector2D position = batch.position[i];
+            if (Method == IntegrationMethod::Euler) {
+                // Position advances with the velocity from the start of the step
+                batch.position[i] = position + v * dt;
+                batch.velocity[i] = v + acceleration * dt;
+            } else if (Method == IntegrationMethod::SemiImplicitEuler) {
+                const Vector2D newVelocity = v + acceleration * dt;
+                batch.velocity[i] = newVelocity;
+                batch.position[i] = position + newVelocity * dt;
+            } else {
+                // x + (x - previous) + a dt^2, with the last step's move kept
+                // as v dt: taken from positions, it would lose the low digits
+                // of a short step's move far from the origin
+                const Vector2D move = v * dt + acceleration * (dt * dt);
+                batch.previousPosition[i] = position;
+                batch.velocity[i] = move / dt;
+                batch.position[i] = position + move;
+            }
+            batch.force[i] = Vector2D(0, 0);
+        }
+    }
+
+    static void measure(const BodyBatch& batch, BodyMoments& moments) {
+        float kinetic = 0.0f, momentumX = 0.0f, momentumY = 0.0f;
+        float massX = 0.0f, massY = 0.0f, mass = 0.0f;
+        for (size_t i = 0; i < batch.count; ++i) {
+            const float m = batch.mass[i];
+            const Vector2D v = batch.velocity[i];
+            const Vector2D p = batch.position[i];
+            kinetic += m * v.x * v.x + m * v.y * v.y;
+            momentumX += m * v.x;
+            momentumY += m * v.y;
+            massX += m * p.x;
+            massY += m * p.y;
+            mass += m;
+        }
+        moments.kinetic = kinetic;
+        moments.momentumX = momentumX;
+        moments.momentumY = momentumY;
+        moments.massX = massX;
+        moments.massY = massY;
+        moments.mass = mass;
+    }
+};
+
+const KernelTable kScalarKernels = makeKernelTable<ScalarKernels>("scalar");
+
+const KernelTable* selectBestKernels() {
+    // PHYSICA_SIMD=scalar|sse2|avx2|avx512 caps the choice (for benchmarking)
+    const char* limit = std::getenv("PHYSICA_SIMD");
+    std::vector<const KernelTable*> tables = getAvailableKernels();
+    const KernelTable* best = tables.front();
+    for (const KernelTable* table : tables) {
+        best = table;
+        if (limit && std::strcmp(limit, table->name) == 0) break;
+    }
+    return best;
+}
+
+} // namespace
+
+const KernelTable& getScalarKernels() {
+    return kScalarKernels;
+}
+
+const KernelTable& getBestKernels() {
+    static const KernelTable* best = selectBestKernels();
+    return *best;
+}
+
+std::vector<const KernelTable*> getAvailableKernels() {
+    const CpuFeatures& cpu = getCpuFeatures();
+    std::vector<const KernelTable*> tables = {&kScalarKernels};
+    if (cpu.sse2 && getSse2Kernels()) tables.push_back(getSse2Kernels());
+    if (cpu.avx2 && getAvx2Kernels()) tables.push_back(getAvx2Kernels());
+    if (cpu.avx512f && getAvx512Kernels()) tables.push_back(getAvx512Kernels());
+    return tables;
+}
+
+} // namespace Physica
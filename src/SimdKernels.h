@@ -0,0 +1,130 @@
+#pragma once
+#include "PhysicsObject.h"
+#include "Vector2D.h"
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+namespace Physica {
+
+// Pointers into the BodyStorage arrays for a contiguous range of bodies.
+// Vector2D is two packed floats, so the vector arrays are read as floats.
+struct BodyBatch {
+    Vector2D* position;
+    Vector2D* velocity;
+    Vector2D* force;
+    Vector2D* previousPosition;
+    const float* invMass;
+    const float* mass;
+    const float* friction;
+    size_t count;
+};
+
+// Uniform force settings for one step
+struct ForceParams {
+    Vector2D gravity;
+    float airResistance;
+};
+
+// Adds gravity, linear friction and quadratic drag on one body to `force`,
+// in the order the step kernels add them
+inline Vector2D addBuiltInForces(Vector2D force, const Vector2D& velocity, float mass, float friction,
+                                 const ForceParams& params, bool gravity, bool drag) {
+    if (gravity) {
+        force += params.gravity * mass;
+    }
+    if (friction > 0.0f) {
+        force += velocity * (-friction);
+    }
+    if (drag) {
+        // Drag = -c |v|^2 v/|v| = -c |v| v (one sqrt, no divide)
+        float speedSquared = velocity.x * velocity.x + velocity.y * velocity.y;
+        if (speedSquared > 0.0001f) {
+            force += velocity * (-params.airResistance * std::sqrt(speedSquared));
+        }
+    }
+    return force;
+}
+
+// Adds gravity, linear friction and quadratic drag to the accumulated
+// force, integrates, then clears the force, all in one pass
+using StepKernel = void (*)(const BodyBatch& batch, const ForceParams& params, float dt);
+
+// Mass-weighted sums over a batch. Each table sums in float lanes across
+// the batch and adds the lanes up in double, so keep batches to a tile.
+struct BodyMoments {
+    double kinetic = 0.0;    // sum of m |v|^2 (twice the kinetic energy)
+    double momentumX = 0.0;  // sum of m v
+    double momentumY = 0.0;
+    double massX = 0.0;      // sum of m p
+    double massY = 0.0;
+    double mass = 0.0;
+};
+
+// Weights every body in the batch, static or not, by its mass
+using MeasureKernel = void (*)(const BodyBatch& batch, BodyMoments& moments);
+
+// Euler, SemiImplicitEuler and Verlet; XPBD reuses the semi-implicit
+// kernels, and the staged methods have none (see StagedIntegrators)
+constexpr size_t kIntegrationMethodCount = 3;
+
+// Batch kernels for one instruction set. There is one step kernel per
+// integrator and per on/off combination of gravity and drag, each compiled
+// with those choices fixed, so the per-body loop has no branches on them.
+// Static bodies (zero inverse mass) are masked out. All tables perform the
+// same float operations in the same order without FMA, so every
+// instruction set matches the scalar reference bit for bit. The measure
+// kernel is the exception: its sums are grouped by register width, so
+// tables agree only to rounding.
+struct KernelTable {
+    const char* name;
+    // Indexed by [IntegrationMethod][gravity][drag]
+    StepKernel step[kIntegrationMethodCount][2][2];
+    MeasureKernel measure;
+
+    // Null for the staged methods
+    StepKernel select(IntegrationMethod method, bool gravity, bool drag) const {
+        // XPBD substeps predict positions with semi-implicit Euler
+        if (method == IntegrationMethod::Xpbd) {
+            method = IntegrationMethod::SemiImplicitEuler;
+        }
+        if (static_cast<size_t>(method) >= kIntegrationMethodCount) return nullptr;
+        return step[static_cast<size_t>(method)][gravity][drag];
+    }
+};
+
+// Plain C++ reference implementation
+const KernelTable& getScalarKernels();
+
+// Fastest table the CPU supports, picked once at first use
+const KernelTable& getBestKernels();
+
+// Every table usable on this CPU, scalar first
+std::vector<const KernelTable*> getAvailableKernels();
+
+// Per instruction set tables (nullptr when not built for this target)
+const KernelTable* getSse2Kernels();
+const KernelTable* getAvx2Kernels();
+const KernelTable* getAvx512Kernels();
+
+// Fills a table from Kernels::template step<Method, Gravity, Drag>
+template <typename Kernels>
+constexpr KernelTable makeKernelTable(const char* name) {
+    using M = IntegrationMethod;
+    return KernelTable{
+        name,
+        {
+            {{&Kernels::template step<M::Euler, false, false>, &Kernels::template step<M::Euler, false, true>},
+             {&Kernels::template step<M::Euler, true, false>, &Kernels::template step<M::Euler, true, true>}},
+            {{&Kernels::template step<M::SemiImplicitEuler, false, false>,
+              &Kernels::template step<M::SemiImplicitEuler, false, true>},
+             {&Kernels::template step<M::SemiImplicitEuler, true, false>,
+              &Kernels::template step<M::SemiImplicitEuler, true, true>}},
+            {{&Kernels::template step<M::Verlet, false, false>, &Kernels::template step<M::Verlet, false, true>},
+             {&Kernels::template step<M::Verlet, true, false>, &Kernels::template step<M::Verlet, true, true>}},
+        },
+        &Kernels::measure,
+    };
+}
+
+} // namespace Physica
@@ -0,0 +1,78 @@
+#include "SimdKernels.h"
+
+#if defined(__AVX2__)
+#include "SimdKernelsImpl.h"
+#include <immintrin.h>
+#endif
+
+namespace Physica {
+
+#if defined(__AVX2__)
+
+namespace {
+
+// Four bodies per register; tails use masked loads and stores
+struct Avx2Ops {
+    using F = __m256;
+    using Mask = __m256;
+    static constexpr size_t kFloats = 8;
+
+    static __m256i tailMask(size_t n) {
+        const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+        return _mm256_cmpgt_epi32(_mm256_set1_epi32(static_cast<int>(n)), lanes);
+    }
+
+    static F load(const float* p) { return _mm256_loadu_ps(p); }
+    static void store(float* p, F v) { _mm256_storeu_ps(p, v); }
+    static F loadPartial(const float* p, size_t n) { return _mm256_maskload_ps(p, tailMask(n)); }
+    static void storePartial(float* p, F v, size_t n) { _mm256_maskstore_ps(p, tailMask(n), v); }
+
+    static F set1(float value) { return _mm256_set1_ps(value); }
+    static F setPairs(float x, float y) { return _mm256_setr_ps(x, y, x, y, x, y, x, y); }
+    static F zero() { return _mm256_setzero_ps(); }
+
+    static F add(F a, F b) { return _mm256_add_ps(a, b); }
+    static F sub(F a, F b) { return _mm256_sub_ps(a, b); }
+    static F mul(F a, F b) { return _mm256_mul_ps(a, b); }
+    static F div(F a, F b) { return _mm256_div_ps(a, b); }
+    static F sqrt(F a) { return _mm256_sqrt_ps(a); }
+    static F neg(F a) { return _mm256_xor_ps(a, _mm256_set1_ps(-0.0f)); }
+    static F swapPairs(F a) { return _mm256_permute_ps(a, _MM_SHUFFLE(2, 3, 0, 1)); }
+
+    // (s0, s1, s2, s3) -> (s0, s0, s1, s1, s2, s2, s3, s3)
+    static F expandRegister(__m128 s) {
+        __m128 low = _mm_unpacklo_ps(s, s);
+        __m128 high = _mm_unpackhi_ps(s, s);
+        return _mm256_insertf128_ps(_mm256_castps128_ps256(low), high, 1);
+    }
+
+    static F expand(const float* p) { return expandRegister(_mm_loadu_ps(p)); }
+
+    static F expandPartial(const float* p, size_t n) {
+        const __m128i lanes = _mm_setr_epi32(0, 1, 2, 3);
+        __m128i mask = _mm_cmpgt_epi32(_mm_set1_epi32(static_cast<int>(n)), lanes);
+        return expandRegister(_mm_maskload_ps(p, mask));
+    }
+
+    static Mask cmpgt(F a, F b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+    static Mask cmpneq(F a, F b) { return _mm256_cmp_ps(a, b, _CMP_NEQ_UQ); }
+    static F select(Mask m, F a, F b) { return _mm256_blendv_ps(b, a, m); }
+};
+
+const KernelTable kAvx2Kernels = makeKernelTable<SimdKernels<Avx2Ops>>("avx2");
+
+} // namespace
+
+const KernelTable* getAvx2Kernels() {
+    return &kAvx2Kernels;
+}
+
+#else
+
+const KernelTable* getAvx2Kernels() {
+    return nullptr;
+}
+
+#endif
+
+} // namespace Physica
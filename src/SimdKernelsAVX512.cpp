@@ -0,0 +1,81 @@
+#include "SimdKernels.h"
+
+#if defined(__AVX512F__)
+#include "SimdKernelsImpl.h"
+#include <immintrin.h>
+#include <cstdint>
+#endif
+
+namespace Physica {
+
+#if defined(__AVX512F__)
+
+namespace {
+
+// Eight bodies per register; comparisons produce k-masks
+struct Avx512Ops {
+    using F = __m512;
+    using Mask = __mmask16;
+    static constexpr size_t kFloats = 16;
+
+    static __mmask16 tailMask(size_t n) {
+        return static_cast<__mmask16>((1u << n) - 1u);
+    }
+
+    static F load(const float* p) { return _mm512_loadu_ps(p); }
+    static void store(float* p, F v) { _mm512_storeu_ps(p, v); }
+    static F loadPartial(const float* p, size_t n) { return _mm512_maskz_loadu_ps(tailMask(n), p); }
+    static void storePartial(float* p, F v, size_t n) { _mm512_mask_storeu_ps(p, tailMask(n), v); }
+
+    static F set1(float value) { return _mm512_set1_ps(value); }
+    static F setPairs(float x, float y) {
+        return _mm512_setr_ps(x, y, x, y, x, y, x, y, x, y, x, y, x, y, x, y);
+    }
+    static F zero() { return _mm512_setzero_ps(); }
+
+    static F add(F a, F b) { return _mm512_add_ps(a, b); }
+    static F sub(F a, F b) { return _mm512_sub_ps(a, b); }
+    static F mul(F a, F b) { return _mm512_mul_ps(a, b); }
+    static F div(F a, F b) { return _mm512_div_ps(a, b); }
+    static F sqrt(F a) { return _mm512_sqrt_ps(a); }
+    static F neg(F a) {
+        return _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(a), _mm512_set1_epi32(INT32_MIN)));
+    }
+    static F swapPairs(F a) { return _mm512_permute_ps(a, _MM_SHUFFLE(2, 3, 0, 1)); }
+
+    // (s0 .. s7) -> (s0, s0, s1, s1, .. s7, s7)
+    static F expandRegister(__m512 s) {
+        const __m512i index = _mm512_setr_epi32(0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7);
+        return _mm512_maskz_permutexvar_ps(0xFFFF, index, s);
+    }
+
+    static F expand(const float* p) {
+        return expandRegister(_mm512_maskz_loadu_ps(0x00FF, p));
+    }
+
+    static F expandPartial(const float* p, size_t n) {
+        return expandRegister(_mm512_maskz_loadu_ps(tailMask(n), p));
+    }
+
+    static Mask cmpgt(F a, F b) { return _mm512_cmp_ps_mask(a, b, _CMP_GT_OQ); }
+    static Mask cmpneq(F a, F b) { return _mm512_cmp_ps_mask(a, b, _CMP_NEQ_UQ); }
+    static F select(Mask m, F a, F b) { return _mm512_mask_blend_ps(m, b, a); }
+};
+
+const KernelTable kAvx512Kernels = makeKernelTable<SimdKernels<Avx512Ops>>("avx512");
+
+} // namespace
+
+const KernelTable* getAvx512Kernels() {
+    return &kAvx512Kernels;
+}
+
+#else
+
+const KernelTable* getAvx512Kernels() {
+    return nullptr;
+}
+
+#endif
+
+} // namespace Physica
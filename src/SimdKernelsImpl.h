@@ -0,0 +1,166 @@
+#pragma once
+// Generic SIMD batch kernels, included only by the per-instruction-set
+// translation units. Those files are built with extra ISA flags, so
+// everything here has internal linkage and sticks to raw float pointers
+// and intrinsics: no inline function may leak out compiled for a CPU the
+// program later runs without.
+#include "SimdKernels.h"
+#include <cstddef>
+
+namespace Physica {
+namespace {
+
+// Ops provides the register type F, mask type Mask, kFloats lanes and the
+// primitive operations used below. A register holds kFloats / 2 bodies as
+// interleaved (x, y) pairs; per-body scalars are expanded to both lanes.
+template <typename Ops>
+struct SimdKernels {
+    using F = typename Ops::F;
+    using Mask = typename Ops::Mask;
+    static constexpr size_t kBodies = Ops::kFloats / 2;
+
+    static F loadPairs(const Vector2D* p, size_t n) {
+        const float* f = reinterpret_cast<const float*>(p);
+        return n == kBodies ? Ops::load(f) : Ops::loadPartial(f, 2 * n);
+    }
+
+    static void storePairs(Vector2D* p, F value, size_t n) {
+        float* f = reinterpret_cast<float*>(p);
+        if (n == kBodies) {
+            Ops::store(f, value);
+        } else {
+            Ops::storePartial(f, value, 2 * n);
+        }
+    }
+
+    static F loadScalars(const float* p, size_t n) {
+        return n == kBodies ? Ops::expand(p) : Ops::expandPartial(p, n);
+    }
+
+    // Calls body(i, n) over full registers, then once for the tail
+    template <typename Body>
+    static void forEachRegister(size_t count, Body body) {
+        size_t i = 0;
+        for (; i + kBodies <= count; i += kBodies) {
+            body(i, kBodies);
+        }
+        if (i < count) {
+            body(i, count - i);
+        }
+    }
+
+    template <IntegrationMethod Method, bool Gravity, bool Drag>
+    static void step(const BodyBatch& batch, const ForceParams& params, float dt) {
+        const F zero = Ops::zero();
+        const F gravity = Ops::setPairs(params.gravity.x, params.gravity.y);
+        const F dragCoefficient = Ops::set1(-params.airResistance);
+        const F speedThreshold = Ops::set1(0.0001f);
+        const F timeStep = Ops::set1(dt);
+        const F timeStepSquared = Ops::set1(dt * dt);
+
+        forEachRegister(batch.count, [&](size_t i, size_t n) {
+            F invMass = loadScalars(batch.invMass + i, n);
+            Mask dynamic = Ops::cmpneq(invMass, zero);
+            F velocity = loadPairs(batch.velocity + i, n);
+            F force = loadPairs(batch.force + i, n);
+            F total = force;
+
+            if (Gravity) {
+                total = Ops::add(total, Ops::mul(gravity, loadScalars(batch.mass + i, n)));
+            }
+
+            F friction = loadScalars(batch.friction + i, n);
+            Mask rubbing = Ops::cmpgt(friction, zero);
+            total = Ops::select(rubbing, Ops::add(total, Ops::mul(velocity, Ops::neg(friction))), total);
+
+            if (Drag) {
+                F squares = Ops::mul(velocity, velocity);
+                F speedSquared = Ops::add(squares, Ops::swapPairs(squares));
+                Mask moving = Ops::cmpgt(speedSquared, speedThreshold);
+                F scale = Ops::mul(dragCoefficient, Ops::sqrt(speedSquared));
+                total = Ops::select(moving, Ops::add(total, Ops::mul(velocity, scale)), total);
+            }
+
+            F acceleration = Ops::mul(total, invMass);
+            F position = loadPairs(batch.position + i, n);
+            F newPosition;
+            F newVelocity;
+            if (Method == IntegrationMethod::Euler) {
+                newPosition = Ops::add(position, Ops::mul(velocity, timeStep));
+                newVelocity = Ops::add(velocity, Ops::mul(acceleration, timeStep));
+            } else if (Method == IntegrationMethod::SemiImplicitEuler) {
+                newVelocity = Ops::add(velocity, Ops::mul(acceleration, timeStep));
+                newPosition = Ops::add(position, Ops::mul(newVelocity, timeStep));
+            } else {
+                F previous = loadPairs(batch.previousPosition + i, n);
+                F move = Ops::add(Ops::mul(velocity, timeStep), Ops::mul(acceleration, timeStepSquared));
+                newPosition = Ops::add(position, move);
+                newVelocity = Ops::div(move, timeStep);
+                storePairs(batch.previousPosition + i, Ops::select(dynamic, position, previous), n);
+            }
+
+            // Static bodies keep every value, including their force
+            storePairs(batch.velocity + i, Ops::select(dynamic, newVelocity, velocity), n);
+            storePairs(batch.position + i, Ops::select(dynamic, newPosition, position), n);
+            storePairs(batch.force + i, Ops::select(dynamic, zero, force), n);
+        });
+    }
+
+    static void measure(const BodyBatch& batch, BodyMoments& moments) {
+        // Lanes alternate x and y; mass is expanded to both, so the mass
+        // lanes count every body twice
+        F kinetic = Ops::zero();
+        F momentum = Ops::zero();
+        F moment = Ops::zero();
+        F mass = Ops::zero();
+        size_t i = 0;
+        for (; i + kBodies <= batch.count; i += kBodies) {
+            F m = Ops::expand(batch.mass + i);
+            F velocity = Ops::load(reinterpret_cast<const float*>(batch.velocity + i));
+            F position = Ops::load(reinterpret_cast<const float*>(batch.position + i));
+            F weighted = Ops::mul(m, velocity);
+            kinetic = Ops::add(kinetic, Ops::mul(weighted, velocity));
+            momentum = Ops::add(momentum, weighted);
+            moment = Ops::add(moment, Ops::mul(m, position));
+            mass = Ops::add(mass, m);
+        }
+
+        float lanes[4][Ops::kFloats];
+        Ops::store(lanes[0], kinetic);
+        Ops::store(lanes[1], momentum);
+        Ops::store(lanes[2], moment);
+        Ops::store(lanes[3], mass);
+        // Field by field: BodyMoments() would emit its inline constructor
+        // here, compiled for this file's instruction set
+        moments.kinetic = 0.0;
+        moments.momentumX = 0.0;
+        moments.momentumY = 0.0;
+        moments.massX = 0.0;
+        moments.massY = 0.0;
+        moments.mass = 0.0;
+        for (size_t lane = 0; lane < Ops::kFloats; lane += 2) {
+            moments.kinetic += double(lanes[0][lane]) + lanes[0][lane + 1];
+            moments.momentumX += lanes[1][lane];
+            moments.momentumY += lanes[1][lane + 1];
+            moments.massX += lanes[2][lane];
+            moments.massY += lanes[2][lane + 1];
+            moments.mass += lanes[3][lane];
+        }
+
+        // Tail bodies one at a time
+        for (; i < batch.count; ++i) {
+            double m = batch.mass[i];
+            const Vector2D& velocity = batch.velocity[i];
+            const Vector2D& position = batch.position[i];
+            moments.kinetic += m * (double(velocity.x) * velocity.x + double(velocity.y) * velocity.y);
+            moments.momentumX += m * velocity.x;
+            moments.momentumY += m * velocity.y;
+            moments.massX += m * position.x;
+            moments.massY += m * position.y;
+            moments.mass += m;
+        }
+    }
+};
+
+} // namespace
+} // namespace Physica
@@ -0,0 +1,81 @@
+#include "SimdKernels.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PHYSICA_HAS_SSE2 1
+#include "SimdKernelsImpl.h"
+#include <emmintrin.h>
+#include <cstring>
+#endif
+
+namespace Physica {
+
+#ifdef PHYSICA_HAS_SSE2
+
+namespace {
+
+// Two bodies per register. SSE2 has no masked load, so tails go through a
+// small stack buffer.
+struct Sse2Ops {
+    using F = __m128;
+    using Mask = __m128;
+    static constexpr size_t kFloats = 4;
+
+    static F load(const float* p) { return _mm_loadu_ps(p); }
+    static void store(float* p, F v) { _mm_storeu_ps(p, v); }
+
+    static F loadPartial(const float* p, size_t n) {
+        alignas(16) float buffer[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+        std::memcpy(buffer, p, n * sizeof(float));
+        return _mm_load_ps(buffer);
+    }
+
+    static void storePartial(float* p, F v, size_t n) {
+        alignas(16) float buffer[4];
+        _mm_store_ps(buffer, v);
+        std::memcpy(p, buffer, n * sizeof(float));
+    }
+
+    static F set1(float value) { return _mm_set1_ps(value); }
+    static F setPairs(float x, float y) { return _mm_setr_ps(x, y, x, y); }
+    static F zero() { return _mm_setzero_ps(); }
+
+    static F add(F a, F b) { return _mm_add_ps(a, b); }
+    static F sub(F a, F b) { return _mm_sub_ps(a, b); }
+    static F mul(F a, F b) { return _mm_mul_ps(a, b); }
+    static F div(F a, F b) { return _mm_div_ps(a, b); }
+    static F sqrt(F a) { return _mm_sqrt_ps(a); }
+    static F neg(F a) { return _mm_xor_ps(a, _mm_set1_ps(-0.0f)); }
+    static F swapPairs(F a) { return _mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 3, 0, 1)); }
+
+    // (s0, s1) -> (s0, s0, s1, s1)
+    static F expand(const float* p) {
+        __m128 s = _mm_castpd_ps(_mm_load_sd(reinterpret_cast<const double*>(p)));
+        return _mm_unpacklo_ps(s, s);
+    }
+
+    static F expandPartial(const float* p, size_t) {
+        return _mm_set1_ps(p[0]);
+    }
+
+    static Mask cmpgt(F a, F b) { return _mm_cmpgt_ps(a, b); }
+    static Mask cmpneq(F a, F b) { return _mm_cmpneq_ps(a, b); }
+    static F select(Mask m, F a, F b) { return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b)); }
+};
+
+const KernelTable kSse2Kernels = makeKernelTable<SimdKernels<Sse2Ops>>("sse2");
+
+} // namespace
+
+const KernelTable* getSse2Kernels() {
+    return &kSse2Kernels;
+}
+
+#else
+
+const KernelTable* getSse2Kernels() {
+    return nullptr;
+}
+
+#endif
+
+} // namespace Physica
@@ -0,0 +1,153 @@
+#include "SleepManager.h"
+#include <algorithm>
+#include <limits>
+#include <numeric>
+
+namespace Physica {
+
+void SleepManager::wakeTouched(BodyStorage& bodies, const std::vector<BodyPair>& contacts, float wakeSpeed) {
+    if (sleepingCount == 0) return;
+
+    // Sleepers do not move, so the awake body's speed is the impact speed
+    const float wakeSpeedSquared = wakeSpeed * wakeSpeed;
+    islandsToWake.clear();
+    for (const BodyPair& contact : contacts) {
+        BodyMotion a = bodies.motion[contact.a];
+        BodyMotion b = bodies.motion[contact.b];
+        if (a == BodyMotion::Sleeping && b == BodyMotion::Dynamic) {
+            if (bodies.velocity[contact.b].magnitudeSquared() > wakeSpeedSquared) {
+                islandsToWake.push_back(bodies.sleepIsland[contact.a]);
+            }
+        } else if (b == BodyMotion::Sleeping && a == BodyMotion::Dynamic) {
+            if (bodies.velocity[contact.a].magnitudeSquared() > wakeSpeedSquared) {
+                islandsToWake.push_back(bodies.sleepIsland[contact.b]);
+            }
+        }
+    }
+    wakeIslands(bodies);
+}
+
+void SleepManager::update(BodyStorage& bodies, const std::vector<BodyPair>& contacts, float maxDrift,
+                          float timeToSleep, float dt) {
+    const size_t count = bodies.size();
+    const float maxDriftSquared = maxDrift * maxDrift;
+
+    // Recounted every step, so bodies edited outside the manager cannot
+    // leave the count stale for long
+    sleepingCount = 0;
+    bool anyReady = false;
+    for (size_t i = 0; i < count; ++i) {
+        if (bodies.motion[i] == BodyMotion::Sleeping) ++sleepingCount;
+        if (bodies.motion[i] != BodyMotion::Dynamic) continue;
+
+        // Leaving the rest radius starts a new rest period from here
+        if ((bodies.position[i] - bodies.sleepAnchor[i]).magnitudeSquared() <= maxDriftSquared) {
+            bodies.sleepTimer[i] += dt;
+            anyReady = anyReady || bodies.sleepTimer[i] >= timeToSleep;
+        } else {
+            bodies.sleepAnchor[i] = bodies.position[i];
+            bodies.sleepTimer[i] = 0.0f;
+        }
+    }
+    if (!anyReady) return;
+
+    // Islands: union every contact between two dynamic bodies
+    parent.resize(count);
+    std::iota(parent.begin(), parent.end(), 0u);
+    for (const BodyPair& contact : contacts) {
+        if (bodies.motion[contact.a] != BodyMotion::Dynamic || bodies.motion[contact.b] != BodyMotion::Dynamic) {
+            continue;
+        }
+        std::uint32_t rootA = findRoot(contact.a);
+        std::uint32_t rootB = findRoot(contact.b);
+        if (rootA != rootB) parent[rootB] = rootA;
+    }
+
+    // An island is as ready as its least rested member
+    islandTimer.assign(count, std::numeric_limits<float>::max());
+    for (size_t i = 0; i < count; ++i) {
+        if (bodies.motion[i] != BodyMotion::Dynamic) continue;
+        std::uint32_t root = findRoot(static_cast<std::uint32_t>(i));
+        islandTimer[root] = std::min(islandTimer[root], bodies.sleepTimer[i]);
+    }
+
+    islandId.assign(count, 0);
+    for (size_t i = 0; i < count; ++i) {
+        if (bodies.motion[i] != BodyMotion::Dynamic) continue;
+        std::uint32_t root = findRoot(static_cast<std::uint32_t>(i));
+        if (islandTimer[root] < timeToSleep) continue;
+
+        if (islandId[root] == 0) {
+            islandId[root] = nextIsland++;
+            if (nextIsland == 0) nextIsland = 1;
+        }
+        bodies.motion[i] = BodyMotion::Sleeping;
+        bodies.sleepIsland[i] = islandId[root];
+        bodies.invMass[i] = 0.0f;
+        bodies.velocity[i] = Vector2D(0, 0);
+        bodies.force[i] = Vector2D(0, 0);
+        bodies.previousPosition[i] = bodies.position[i];
+        ++sleepingCount;
+    }
+}
+
+void SleepManager::wakeBody(BodyStorage& bodies, size_t index) {
+    if (index >= bodies.size() || bodies.motion[index] != BodyMotion::Sleeping) return;
+
+    islandsToWake.clear();
+    islandsToWake.push_back(bodies.sleepIsland[index]);
+    wakeIslands(bodies);
+}
+
+void SleepManager::wakeAll(BodyStorage& bodies) {
+    for (size_t i = 0; i < bodies.size(); ++i) {
+        if (bodies.motion[i] == BodyMotion::Sleeping) wake(bodies, i);
+    }
+    sleepingCount = 0;
+}
+
+void SleepManager::resync(const BodyStorage& bodies) {
+    sleepingCount = 0;
+    std::uint32_t lastIsland = 0;
+    for (size_t i = 0; i < bodies.size(); ++i) {
+        if (bodies.motion[i] != BodyMotion::Sleeping) continue;
+        ++sleepingCount;
+        lastIsland = std::max(lastIsland, bodies.sleepIsland[i]);
+    }
+    nextIsland = std::max(nextIsland, lastIsland + 1);
+    if (nextIsland == 0) nextIsland = 1;
+}
+
+std::uint32_t SleepManager::findRoot(std::uint32_t body) {
+    // Path halving
+    while (parent[body] != body) {
+        parent[body] = parent[parent[body]];
+        body = parent[body];
+    }
+    return body;
+}
+
+void SleepManager::wakeIslands(BodyStorage& bodies) {
+    if (islandsToWake.empty()) return;
+
+    std::sort(islandsToWake.begin(), islandsToWake.end());
+    islandsToWake.erase(std::unique(islandsToWake.begin(), islandsToWake.end()), islandsToWake.end());
+
+    // Sleeping bodies do not keep member lists, so one sweep finds them all
+    for (size_t i = 0; i < bodies.size(); ++i) {
+        if (bodies.motion[i] != BodyMotion::Sleeping) continue;
+        if (std::binary_search(islandsToWake.begin(), islandsToWake.end(), bodies.sleepIsland[i])) {
+            wake(bodies, i);
+            if (sleepingCount > 0) --sleepingCount;
+        }
+    }
+}
+
+void SleepManager::wake(BodyStorage& bodies, size_t index) {
+    bodies.motion[index] = BodyMotion::Dynamic;
+    bodies.invMass[index] = 1.0f / bodies.mass[index];
+    bodies.sleepAnchor[index] = bodies.position[index];
+    bodies.sleepTimer[index] = 0.0f;
+}
+
+} // namespace Physica
@@ -0,0 +1,60 @@
+#pragma once
+#include "BodyStorage.h"
+#include "Broadphase.h"
+#include <cstdint>
+#include <vector>
+
+namespace Physica {
+
+// Puts resting bodies to sleep and wakes them, one contact island at a time.
+// A dynamic body is ready to sleep once it has stayed within a small radius
+// of one spot for timeToSleep seconds, i.e. its mean speed over that window
+// is low. Instantaneous speed is no use here: bodies resting in a stack or
+// on the boundary keep exchanging small impulses every step. Bodies joined
+// by this step's contacts form an island, and an island sleeps only when
+// every member is ready, so a resting pile sleeps as a unit.
+// Sleeping bodies keep zero inverse mass, so the broadphase drops pairs of
+// two of them and they cost nothing in the narrowphase and contact solve.
+// That is all sleeping saves: they stay in the body arrays and still go
+// through the step kernel (which leaves them in place), the broadphase and
+// update's scan every step, so a settled pile costs about as much as its
+// broadphase rather than nothing. An awake body that hits any member
+// faster than the wake speed wakes the whole island; slower neighbours rest
+// against it as if it were static.
+class SleepManager {
+public:
+    // Wakes the islands of sleeping bodies hit by awake bodies moving faster
+    // than wakeSpeed. Call between the narrowphase and resolution so the
+    // contacts see real masses.
+    void wakeTouched(BodyStorage& bodies, const std::vector<BodyPair>& contacts, float wakeSpeed);
+
+    // Advances sleep timers, groups bodies into islands over the contacts and
+    // puts every island whose members are all ready to sleep. A body may
+    // drift up to maxDrift from its anchor and still count as resting.
+    void update(BodyStorage& bodies, const std::vector<BodyPair>& contacts, float maxDrift,
+                float timeToSleep, float dt);
+
+    // Wakes the island the body belongs to (no-op when it is awake)
+    void wakeBody(BodyStorage& bodies, size_t index);
+    void wakeAll(BodyStorage& bodies);
+
+    // Recounts sleepers and moves island ids past the ones in use, after
+    // the body arrays were replaced wholesale
+    void resync(const BodyStorage& bodies);
+
+    size_t getSleepingCount() const { return sleepingCount; }
+
+private:
+    std::vector<std::uint32_t> parent;       // Union-find forest over bodies
+    std::vector<float> islandTimer;          // Shortest sleep timer per root
+    std::vector<std::uint32_t> islandId;     // Id handed to a root's island
+    std::vector<std::uint32_t> islandsToWake;
+    std::uint32_t nextIsland = 1;
+    size_t sleepingCount = 0;
+
+    std::uint32_t findRoot(std::uint32_t body);
+    void wakeIslands(BodyStorage& bodies);
+    void wake(BodyStorage& bodies, size_t index);
+};
+
+} // namespace Physica
@@ -0,0 +1,71 @@
+#include "StagedIntegrators.h"
+
+namespace Physica {
+
+namespace {
+
+// Everything the step evaluates forces with, for one body
+struct Stage {
+    const ForceParams& params;
+    const ForceFieldPipeline& fields;
+    Vector2D held;  // Force accumulated before the step
+    float mass;
+    float invMass;
+    float friction;
+    bool gravity;
+    bool drag;
+
+    Vector2D acceleration(const Vector2D& position, const Vector2D& velocity) const {
+        Vector2D force = fields.force(position, mass, held);
+        return addBuiltInForces(force, velocity, mass, friction, params, gravity, drag) * invMass;
+    }
+};
+
+void stepVelocityVerlet(const Stage& stage, Vector2D& position, Vector2D& velocity, float dt) {
+    // The end acceleration is taken at the velocity an Euler step predicts,
+    // which is exact for the position-only forces
+    const Vector2D a0 = stage.acceleration(position, velocity);
+    const Vector2D end = position + velocity * dt + a0 * (0.5f * dt * dt);
+    const Vector2D a1 = stage.acceleration(end, velocity + a0 * dt);
+    position = end;
+    velocity = velocity + (a0 + a1) * (0.5f * dt);
+}
+
+void stepRk4(const Stage& stage, Vector2D& position, Vector2D& velocity, float dt) {
+    const float half = 0.5f * dt;
+    const Vector2D x1 = position, v1 = velocity;
+    const Vector2D a1 = stage.acceleration(x1, v1);
+    const Vector2D x2 = position + v1 * half, v2 = velocity + a1 * half;
+    const Vector2D a2 = stage.acceleration(x2, v2);
+    const Vector2D x3 = position + v2 * half, v3 = velocity + a2 * half;
+    const Vector2D a3 = stage.acceleration(x3, v3);
+    const Vector2D x4 = position + v3 * dt, v4 = velocity + a3 * dt;
+    const Vector2D a4 = stage.acceleration(x4, v4);
+    const float sixth = dt / 6.0f;
+    position = position + (v1 + (v2 + v3) * 2.0f + v4) * sixth;
+    velocity = velocity + (a1 + (a2 + a3) * 2.0f + a4) * sixth;
+}
+
+} // namespace
+
+bool isStagedMethod(IntegrationMethod method) {
+    return method == IntegrationMethod::VelocityVerlet || method == IntegrationMethod::Rk4;
+}
+
+void stepStaged(IntegrationMethod method, const BodyBatch& batch, const ForceParams& params, bool gravity,
+                bool drag, const ForceFieldPipeline& fields, float dt) {
+    for (size_t i = 0; i < batch.count; ++i) {
+        const float invMass = batch.invMass[i];
+        if (invMass == 0.0f) continue;
+
+        const Stage stage{params, fields, batch.force[i], batch.mass[i], invMass, batch.friction[i], gravity, drag};
+        if (method == IntegrationMethod::Rk4) {
+            stepRk4(stage, batch.position[i], batch.velocity[i], dt);
+        } else {
+            stepVelocityVerlet(stage, batch.position[i], batch.velocity[i], dt);
+        }
+        batch.force[i] = Vector2D(0, 0);
+    }
+}
+
+} // namespace Physica
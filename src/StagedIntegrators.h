@@ -0,0 +1,20 @@
+#pragma once
+#include "ForceFields.h"
+#include "SimdKernels.h"
+
+namespace Physica {
+
+// Integrators that evaluate the forces more than once per step: velocity
+// Verlet (twice) and classic fourth-order Runge-Kutta (four times). Force
+// fields are sampled at each stage's position and the built-in forces at
+// each stage's velocity; the force already accumulated on a body (applied
+// by hand, or by mutual gravity) is held for the whole step. They are
+// scalar: their cost is in the force evaluations, and the fields are
+// scalar anyway. As in the step kernels, static bodies are skipped and the
+// force is cleared.
+bool isStagedMethod(IntegrationMethod method);
+
+void stepStaged(IntegrationMethod method, const BodyBatch& batch, const ForceParams& params, bool gravity,
+                bool drag, const ForceFieldPipeline& fields, float dt);
+
+} // namespace Physica
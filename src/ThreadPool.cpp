@@ -0,0 +1,110 @@
+#include "ThreadPool.h"
+#include <algorithm>
+
+namespace Physica {
+
+namespace {
+
+// Chunks per thread, so uneven chunks still balance out
+constexpr size_t kChunksPerThread = 4;
+
+} // namespace
+
+ThreadPool::ThreadPool(size_t threadCount) {
+    setThreadCount(threadCount);
+}
+
+ThreadPool::~ThreadPool() {
+    stopWorkers();
+}
+
+void ThreadPool::setThreadCount(size_t threadCount) {
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    if (threadCount == getThreadCount()) return;
+
+    stopWorkers();
+    startWorkers(threadCount - 1);
+}
+
+size_t ThreadPool::chunkSize(size_t count, size_t minChunk, size_t granularity) const {
+    granularity = std::max<size_t>(granularity, 1);
+    size_t target = count / (getThreadCount() * kChunksPerThread);
+    size_t chunk = std::max(target, minChunk);
+    // Round up to a whole number of cache lines
+    return (chunk + granularity - 1) / granularity * granularity;
+}
+
+void ThreadPool::dispatch(size_t count, size_t chunk, ChunkFn fn, void* context) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        jobFn = fn;
+        jobContext = context;
+        jobCount = count;
+        jobChunk = chunk;
+        nextChunk.store(0, std::memory_order_relaxed);
+        busyWorkers = workers.size();
+        ++generation;
+    }
+    wakeCondition.notify_all();
+
+    runChunks();
+
+    std::unique_lock<std::mutex> lock(mutex);
+    doneCondition.wait(lock, [this] { return busyWorkers == 0; });
+}
+
+void ThreadPool::runChunks() {
+    const size_t chunkCount = (jobCount + jobChunk - 1) / jobChunk;
+    for (;;) {
+        size_t index = nextChunk.fetch_add(1, std::memory_order_relaxed);
+        if (index >= chunkCount) break;
+
+        size_t begin = index * jobChunk;
+        size_t end = std::min(begin + jobChunk, jobCount);
+        jobFn(jobContext, begin, end);
+    }
+}
+
+void ThreadPool::workerLoop(size_t seenGeneration) {
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wakeCondition.wait(lock, [&] { return stopping || generation != seenGeneration; });
+            if (stopping) return;
+            seenGeneration = generation;
+        }
+
+        runChunks();
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (--busyWorkers == 0) {
+            doneCondition.notify_one();
+        }
+    }
+}
+
+void ThreadPool::startWorkers(size_t workerCount) {
+    stopping = false;
+    workers.reserve(workerCount);
+    for (size_t i = 0; i < workerCount; ++i) {
+        // Pass the current generation so a job dispatched before the
+        // thread first runs is not missed
+        workers.emplace_back(&ThreadPool::workerLoop, this, generation);
+    }
+}
+
+void ThreadPool::stopWorkers() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wakeCondition.notify_all();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    workers.clear();
+}
+
+} // namespace Physica
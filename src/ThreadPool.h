@@ -0,0 +1,78 @@
+#pragma once
+#include "AlignedAllocator.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace Physica {
+
+// Persistent worker threads for data-parallel loops over body ranges.
+// The calling thread takes part in every loop, so a pool with a thread
+// count of 1 has no workers and runs everything inline.
+// parallelFor is not reentrant: do not call it from inside a chunk.
+class ThreadPool {
+public:
+    // 0 means one thread per hardware core
+    explicit ThreadPool(size_t threadCount = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    void setThreadCount(size_t threadCount);
+    size_t getThreadCount() const { return workers.size() + 1; }
+
+    // Calls fn(begin, end) over [0, count) in chunks of at least minChunk
+    // items. Chunk sizes are whole multiples of `granularity` so that
+    // neighbouring chunks never write to the same cache line. Runs
+    // serially when the range fits in a single chunk.
+    template <typename Fn>
+    void parallelFor(size_t count, size_t minChunk, size_t granularity, Fn&& fn) {
+        if (count == 0) return;
+
+        size_t chunk = chunkSize(count, minChunk, granularity);
+        if (workers.empty() || chunk >= count) {
+            fn(size_t(0), count);
+            return;
+        }
+
+        using Callable = std::remove_reference_t<Fn>;
+        auto invoke = [](void* context, size_t begin, size_t end) {
+            (*static_cast<Callable*>(context))(begin, end);
+        };
+        dispatch(count, chunk, invoke, const_cast<void*>(static_cast<const void*>(&fn)));
+    }
+
+private:
+    using ChunkFn = void (*)(void*, size_t, size_t);
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wakeCondition;
+    std::condition_variable doneCondition;
+    size_t generation = 0;
+    size_t busyWorkers = 0;
+    bool stopping = false;
+
+    // Current job (written under the mutex before workers are woken)
+    ChunkFn jobFn = nullptr;
+    void* jobContext = nullptr;
+    size_t jobCount = 0;
+    size_t jobChunk = 0;
+
+    // Last member and cache-line aligned, so it sits on its own line
+    alignas(kCacheLineSize) std::atomic<size_t> nextChunk{0};
+
+    size_t chunkSize(size_t count, size_t minChunk, size_t granularity) const;
+    void dispatch(size_t count, size_t chunk, ChunkFn fn, void* context);
+    void runChunks();
+    void workerLoop(size_t seenGeneration);
+    void startWorkers(size_t workerCount);
+    void stopWorkers();
+};
+
+} // namespace Physica
@@ -0,0 +1,122 @@
+#include "TrajectoryPredictor.h"
+#include "StagedIntegrators.h"
+#include <algorithm>
+#include <cmath>
+
+namespace Physica {
+
+TrajectoryPredictor::TrajectoryPredictor() {
+    points.reserve(maxSteps + 1);
+}
+
+void TrajectoryPredictor::clear() {
+    points.clear();
+    stop = Stop::None;
+}
+
+void TrajectoryPredictor::predict(const PhysicsEngine& engine, size_t index, const Vector2D& position,
+                                  const Vector2D& velocity, float dt) {
+    clear();
+    const BodyStorage& bodies = engine.getBodies();
+    if (index >= bodies.size() || bodies.motion[index] == BodyMotion::Static) return;
+
+    // The body as a batch of one, picked up by the same kernel step() uses
+    Vector2D bodyPosition = position;
+    Vector2D bodyVelocity = velocity;
+    Vector2D force(0, 0);
+    Vector2D previousPosition = position - velocity * dt;
+    const float mass = bodies.mass[index];
+    const float invMass = 1.0f / mass;
+    const float friction = bodies.friction[index];
+    BodyBatch batch{&bodyPosition, &bodyVelocity, &force, &previousPosition, &invMass, &mass, &friction, 1};
+
+    const KernelTable& kernels = engine.simdEnabled ? getBestKernels() : getScalarKernels();
+    ForceParams forces;
+    forces.gravity = engine.getGravity();
+    forces.airResistance = engine.airResistanceCoefficient;
+    const bool uniformGravity = engine.gravityEnabled && engine.getGravityMode() == GravityMode::Uniform;
+    const IntegrationMethod method = engine.getIntegrationMethod();
+    const bool drag = engine.airResistanceCoefficient > 0.0f;
+    StepKernel stepKernel = kernels.select(method, uniformGravity, drag);
+    const ForceFieldPipeline& fields = engine.getForceFields();
+    // XPBD steps are taken as that many kernel substeps
+    const int substeps = method == IntegrationMethod::Xpbd
+                             ? std::max(engine.getXpbdSolver().substeps, 1)
+                             : 1;
+    const float h = dt / substeps;
+
+    const bool collide = engine.collisionsEnabled && bodies.size() > 1;
+    if (collide) {
+        grid.build(bodies);
+    }
+    const Vector2D half = bodies.halfExtents(index);
+    const Vector2D bounds = engine.getBounds();
+
+    if (points.capacity() < maxSteps + 1) {
+        points.reserve(maxSteps + 1);
+    }
+    points.push_back(bodyPosition);
+    for (size_t step = 0; step < maxSteps; ++step) {
+        const Vector2D from = bodyPosition;
+        for (int substep = 0; substep < substeps; ++substep) {
+            if (isStagedMethod(method)) {
+                stepStaged(method, batch, forces, uniformGravity, drag, fields, h);
+            } else {
+                if (!fields.empty()) {
+                    fields.accumulate(batch);
+                }
+                stepKernel(batch, forces, h);
+            }
+        }
+        if (!std::isfinite(bodyPosition.x) || !std::isfinite(bodyPosition.y)) break;
+        points.push_back(bodyPosition);
+
+        if (engine.boundaryEnabled &&
+            (bodyPosition.x - half.x < 0.0f || bodyPosition.y - half.y < 0.0f ||
+             bodyPosition.x + half.x > bounds.x || bodyPosition.y + half.y > bounds.y)) {
+            stop = Stop::Wall;
+            break;
+        }
+        if (collide && touchesBody(bodies, index, from, bodyPosition)) {
+            stop = Stop::Body;
+            break;
+        }
+    }
+}
+
+bool TrajectoryPredictor::touchesBody(const BodyStorage& bodies, size_t index, const Vector2D& from,
+                                      const Vector2D& to) {
+    // Every body near this step's swept bounding circle
+    const float radius = bodies.boundingRadius(index);
+    Vector2D low(std::min(from.x, to.x) - radius, std::min(from.y, to.y) - radius);
+    Vector2D high(std::max(from.x, to.x) + radius, std::max(from.y, to.y) + radius);
+    candidates.clear();
+    grid.query(low, high, candidates);
+
+    // Earliest contact along the sweep, so fast launches do not tunnel.
+    // Bodies already touching at the launch point (a floor pile the body
+    // rests on) are not new contacts.
+    const Vector2D sweep = to - from;
+    const float sweepLengthSquared = sweep.x * sweep.x + sweep.y * sweep.y;
+    bool hit = false;
+    float earliest = 2.0f;
+    for (std::uint32_t other : candidates) {
+        if (other == index) continue;
+        const float reach = radius + bodies.boundingRadius(other);
+        const Vector2D start = bodies.position[other] - points.front();
+        if (start.x * start.x + start.y * start.y < reach * reach) continue;
+
+        const Vector2D offset = bodies.position[other] - from;
+        float t = sweepLengthSquared > 0.0f ? (offset.x * sweep.x + offset.y * sweep.y) / sweepLengthSquared : 0.0f;
+        t = std::clamp(t, 0.0f, 1.0f);
+        const Vector2D gap = offset - sweep * t;
+        if (gap.x * gap.x + gap.y * gap.y < reach * reach && t < earliest) {
+            hit = true;
+            earliest = t;
+            contactBody = other;
+        }
+    }
+    return hit;
+}
+
+} // namespace Physica
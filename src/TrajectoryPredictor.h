@@ -0,0 +1,51 @@
+#pragma once
+#include "PhysicsEngine.h"
+#include <cstdint>
+#include <vector>
+
+namespace Physica {
+
+// Predicts where a body goes if launched from a position with a velocity.
+// The body is stepped alone with the engine's own step kernel, force
+// fields, gravity and drag, at the engine's time step (in substeps for
+// IntegrationMethod::Xpbd), while the other bodies stay where they are.
+// The path stops at the first contact: a wall, or another body found by a
+// uniform grid query around each step's sweep (bounding circles, so the
+// stop is slightly early for boxes). Mutual gravity is not predicted.
+// Buffers are sized once, so predicting does not allocate after the first
+// call on a world of a given size.
+class TrajectoryPredictor {
+public:
+    enum class Stop {
+        None,  // Ran for maxSteps
+        Wall,
+        Body
+    };
+
+    TrajectoryPredictor();
+
+    // Call between steps, on the thread that steps the engine
+    void predict(const PhysicsEngine& engine, size_t index, const Vector2D& position, const Vector2D& velocity,
+                 float dt);
+    void clear();
+
+    // Launch position first, then one point per step
+    const AlignedVector<Vector2D>& getPoints() const { return points; }
+    Stop getStop() const { return stop; }
+    std::uint32_t getContactBody() const { return contactBody; }  // Valid when stopped by a body
+
+    // Settings
+    size_t maxSteps = 180;
+
+private:
+    AlignedVector<Vector2D> points;
+    Stop stop = Stop::None;
+    std::uint32_t contactBody = 0;
+
+    UniformGridBroadphase grid;
+    std::vector<std::uint32_t> candidates;
+
+    bool touchesBody(const BodyStorage& bodies, size_t index, const Vector2D& from, const Vector2D& to);
+};
+
+} // namespace Physica
@@ -0,0 +1,47 @@
+#pragma once
+#include "AlignedAllocator.h"
+#include <atomic>
+#include <cstdint>
+
+namespace Physica {
+
+// Lock-free hand-off of whole values from one writer thread to one reader
+// thread. The writer fills writeBuffer() and publishes it; the reader
+// always gets the newest published value. Neither side ever waits: each
+// owns one slot, and the third is swapped through an atomic index. Values
+// the reader never picked up are overwritten, so slots keep their
+// allocations and steady-state publishing does not allocate.
+template <typename T>
+class TripleBuffer {
+public:
+    // Writer side: the slot to fill, valid until publish()
+    T& writeBuffer() { return slots[back]; }
+
+    void publish() {
+        back = shared.exchange(back | kFresh, std::memory_order_acq_rel) & kIndexMask;
+    }
+
+    // Reader side: the newest published value. It stays valid and
+    // unchanged until the next acquire().
+    const T& acquire() {
+        if (shared.load(std::memory_order_relaxed) & kFresh) {
+            front = shared.exchange(front, std::memory_order_acq_rel) & kIndexMask;
+        }
+        return slots[front];
+    }
+
+    // True when a value has been published since the last acquire()
+    bool hasFresh() const { return shared.load(std::memory_order_relaxed) & kFresh; }
+
+private:
+    static constexpr std::uint8_t kIndexMask = 0x3;
+    static constexpr std::uint8_t kFresh = 0x4;  // Shared slot not yet read
+
+    T slots[3];
+    // Each side's index on its own cache line
+    alignas(kCacheLineSize) std::uint8_t back = 0;   // Writer's slot
+    alignas(kCacheLineSize) std::uint8_t front = 1;  // Reader's slot
+    alignas(kCacheLineSize) std::atomic<std::uint8_t> shared{2};
+};
+
+} // namespace Physica
@@ -0,0 +1,477 @@
+#include "WorldSnapshot.h"
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <type_traits>
+#include <vector>
+
+#if defined(_WIN32)
+#include <fstream>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Physica {
+
+namespace {
+
+constexpr char kMagic[8] = {'P', 'H', 'Y', 'S', 'N', 'A', 'P', '\0'};
+constexpr std::uint32_t kVersion = 1;
+constexpr std::uint32_t kByteOrderMark = 0x01020304;
+
+// Ids of the arrays in the field table. New fields get new ids; readers
+// skip ids they do not know.
+enum FieldId : std::uint32_t {
+    kPosition = 1,
+    kVelocity,
+    kForce,
+    kPreviousPosition,
+    kInvMass,
+    kRadius,
+    kRestitution,
+    kMass,
+    kFriction,
+    kExtents,
+    kShape,
+    kMotion,
+    kSleepAnchor,
+    kSleepTimer,
+    kSleepIsland,
+    kColor,         // r, g, b per body
+    kLabelOffsets,  // Body count + 1 offsets into kLabelChars
+    kLabelChars,
+    kUniformFields,
+    kRadialFields,
+    kVortexFields,
+    kBullet,
+    kSpringFields,
+    kXpbdSettings,  // One XpbdSettings
+    kFieldIdLimit
+};
+
+// Header::flags bits. Plain constants rather than an enum, so a flag and
+// an unset 0 share a type in conditionals.
+constexpr std::uint32_t kGravityEnabled = 1u << 0;
+constexpr std::uint32_t kCollisionsEnabled = 1u << 1;
+constexpr std::uint32_t kBoundaryEnabled = 1u << 2;
+constexpr std::uint32_t kSleepingEnabled = 1u << 3;
+
+struct Header {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t byteOrder;
+    std::uint64_t bodyCount;
+    std::uint64_t stepCount;
+    std::uint32_t fieldCount;
+    std::uint32_t flags;  // k*Enabled bits
+    float gravity[2];
+    float bounds[2];
+    float airResistance;
+    float sleepVelocity;
+    float timeToSleep;
+    float wakeVelocity;
+    float gravitationalConstant;
+    float theta;
+    float softening;
+    std::uint32_t leafSize;
+    std::uint8_t integrationMethod;
+    std::uint8_t broadphaseMethod;
+    std::uint8_t gravityMode;
+    std::uint8_t reserved[5];
+};
+static_assert(sizeof(Header) == 96, "snapshot header layout changed");
+
+struct FieldEntry {
+    std::uint32_t id;
+    std::uint32_t elementSize;
+    std::uint64_t offset;  // From the start of the file, cache line aligned
+    std::uint64_t size;    // Bytes
+};
+static_assert(sizeof(FieldEntry) == 24, "snapshot field entry layout changed");
+
+// XpbdSolver's parameters; the header has no room left for them
+struct XpbdSettings {
+    std::int32_t substeps;
+    float contactCompliance;
+    float wallCompliance;
+};
+
+size_t alignToCacheLine(size_t offset) {
+    return (offset + kCacheLineSize - 1) / kCacheLineSize * kCacheLineSize;
+}
+
+// Array to write, with its table entry
+struct OutputField {
+    FieldEntry entry;
+    const void* data;
+};
+
+template <typename T>
+void addField(std::vector<OutputField>& fields, FieldId id, const T* data, size_t count) {
+    static_assert(std::is_trivially_copyable<T>::value, "snapshot arrays are copied as bytes");
+    fields.push_back({{id, static_cast<std::uint32_t>(sizeof(T)), 0, count * sizeof(T)}, data});
+}
+
+// Read-only view of a whole file: mapped where the platform allows,
+// otherwise read into memory
+class MappedFile {
+public:
+    MappedFile() = default;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+#if defined(_WIN32)
+    bool open(const std::string& path) {
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (!file) return false;
+        buffer.resize(static_cast<size_t>(file.tellg()));
+        file.seekg(0);
+        return static_cast<bool>(file.read(reinterpret_cast<char*>(buffer.data()), buffer.size()));
+    }
+
+    const unsigned char* data() const { return buffer.data(); }
+    size_t size() const { return buffer.size(); }
+
+private:
+    AlignedVector<unsigned char> buffer;
+#else
+    ~MappedFile() {
+        if (mapping) munmap(mapping, length);
+    }
+
+    bool open(const std::string& path) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat info;
+        if (fstat(fd, &info) != 0 || info.st_size <= 0) {
+            ::close(fd);
+            return false;
+        }
+        int flags = MAP_PRIVATE;
+#ifdef MAP_POPULATE
+        flags |= MAP_POPULATE;  // Fault every page in up front, in bulk
+#endif
+        void* address = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, flags, fd, 0);
+        ::close(fd);
+        if (address == MAP_FAILED) return false;
+        mapping = address;
+        length = static_cast<size_t>(info.st_size);
+        return true;
+    }
+
+    const unsigned char* data() const { return static_cast<const unsigned char*>(mapping); }
+    size_t size() const { return length; }
+
+private:
+    void* mapping = nullptr;
+    size_t length = 0;
+#endif
+};
+
+// Checked field table of a mapped snapshot
+class SnapshotReader {
+public:
+    bool open(const MappedFile& file) {
+        base = file.data();
+        if (file.size() < sizeof(Header)) return false;
+        std::memcpy(&header, base, sizeof(Header));
+        if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0) return false;
+        if (header.version != kVersion || header.byteOrder != kByteOrderMark) return false;
+        if (header.integrationMethod > static_cast<std::uint8_t>(IntegrationMethod::Rk4) ||
+            header.broadphaseMethod > static_cast<std::uint8_t>(BroadphaseMethod::SweepAndPrune) ||
+            header.gravityMode > static_cast<std::uint8_t>(GravityMode::Mutual)) {
+            return false;
+        }
+
+        const size_t fileSize = file.size();
+        if (header.fieldCount > (fileSize - sizeof(Header)) / sizeof(FieldEntry)) return false;
+        for (std::uint32_t i = 0; i < header.fieldCount; ++i) {
+            FieldEntry entry;
+            std::memcpy(&entry, base + sizeof(Header) + i * sizeof(FieldEntry), sizeof(FieldEntry));
+            if (entry.offset > fileSize || entry.size > fileSize - entry.offset) return false;
+            if (entry.offset % kCacheLineSize != 0) return false;
+            if (entry.elementSize == 0 || entry.size % entry.elementSize != 0) return false;
+            if (entry.id < kFieldIdLimit) {
+                entries[entry.id] = entry;
+                present[entry.id] = true;
+            }
+        }
+        return true;
+    }
+
+    const Header& getHeader() const { return header; }
+
+    // Array of `id` and its element count, or nullptr when it is missing
+    // or of the wrong type
+    template <typename T>
+    const T* find(FieldId id, size_t& count) const {
+        if (!present[id] || entries[id].elementSize != sizeof(T)) return nullptr;
+        count = static_cast<size_t>(entries[id].size / sizeof(T));
+        return reinterpret_cast<const T*>(base + entries[id].offset);
+    }
+
+    template <typename T>
+    const T* findPerBody(FieldId id) const {
+        size_t count = 0;
+        const T* data = find<T>(id, count);
+        return data && count == header.bodyCount ? data : nullptr;
+    }
+
+private:
+    const unsigned char* base = nullptr;
+    Header header;
+    FieldEntry entries[kFieldIdLimit] = {};
+    bool present[kFieldIdLimit] = {};
+};
+
+template <typename Vector>
+void adopt(Vector& target, const typename Vector::value_type* data, size_t count) {
+    target.assign(data, data + count);
+}
+
+template <typename Field>
+void addFields(PhysicsEngine& engine, const SnapshotReader& reader, FieldId id) {
+    size_t count = 0;
+    const Field* fields = reader.find<Field>(id, count);
+    if (!fields) return;
+    for (size_t i = 0; i < count; ++i) {
+        engine.addForceField(fields[i]);
+    }
+}
+
+} // namespace
+
+bool saveWorldSnapshot(const PhysicsEngine& engine, const std::string& path) {
+    const BodyStorage& bodies = engine.getBodies();
+    const size_t count = bodies.size();
+
+    // Colors and labels live in a side table of structs; flatten them
+    std::vector<float> colors(count * 3);
+    std::vector<std::uint64_t> labelOffsets(count + 1, 0);
+    std::string labelChars;
+    for (size_t i = 0; i < count; ++i) {
+        const BodyAppearance& look = bodies.appearance[i];
+        colors[i * 3 + 0] = look.colorR;
+        colors[i * 3 + 1] = look.colorG;
+        colors[i * 3 + 2] = look.colorB;
+        labelChars += look.label;
+        labelOffsets[i + 1] = labelChars.size();
+    }
+
+    std::vector<OutputField> fields;
+    addField(fields, kPosition, bodies.position.data(), count);
+    addField(fields, kVelocity, bodies.velocity.data(), count);
+    addField(fields, kForce, bodies.force.data(), count);
+    addField(fields, kPreviousPosition, bodies.previousPosition.data(), count);
+    addField(fields, kInvMass, bodies.invMass.data(), count);
+    addField(fields, kRadius, bodies.radius.data(), count);
+    addField(fields, kRestitution, bodies.restitution.data(), count);
+    addField(fields, kMass, bodies.mass.data(), count);
+    addField(fields, kFriction, bodies.friction.data(), count);
+    addField(fields, kExtents, bodies.extents.data(), count);
+    addField(fields, kShape, bodies.shape.data(), count);
+    addField(fields, kMotion, bodies.motion.data(), count);
+    addField(fields, kSleepAnchor, bodies.sleepAnchor.data(), count);
+    addField(fields, kSleepTimer, bodies.sleepTimer.data(), count);
+    addField(fields, kSleepIsland, bodies.sleepIsland.data(), count);
+    addField(fields, kBullet, bodies.bullet.data(), count);
+    addField(fields, kColor, colors.data(), colors.size());
+    addField(fields, kLabelOffsets, labelOffsets.data(), labelOffsets.size());
+    addField(fields, kLabelChars, labelChars.data(), labelChars.size());
+    const ForceFieldPipeline& forceFields = engine.getForceFields();
+    addField(fields, kUniformFields, forceFields.get<UniformField>().data(), forceFields.get<UniformField>().size());
+    addField(fields, kRadialFields, forceFields.get<RadialField>().data(), forceFields.get<RadialField>().size());
+    addField(fields, kVortexFields, forceFields.get<VortexField>().data(), forceFields.get<VortexField>().size());
+    addField(fields, kSpringFields, forceFields.get<SpringField>().data(), forceFields.get<SpringField>().size());
+    const XpbdSolver& solver = engine.getXpbdSolver();
+    const XpbdSettings xpbd = {solver.substeps, solver.contactCompliance, solver.wallCompliance};
+    addField(fields, kXpbdSettings, &xpbd, 1);
+
+    size_t offset = sizeof(Header) + fields.size() * sizeof(FieldEntry);
+    for (OutputField& field : fields) {
+        field.entry.offset = alignToCacheLine(offset);
+        offset = field.entry.offset + field.entry.size;
+    }
+
+    Header header = {};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.byteOrder = kByteOrderMark;
+    header.bodyCount = count;
+    header.stepCount = engine.getStepCount();
+    header.fieldCount = static_cast<std::uint32_t>(fields.size());
+    header.flags = (engine.gravityEnabled ? kGravityEnabled : 0u) |
+                   (engine.collisionsEnabled ? kCollisionsEnabled : 0u) |
+                   (engine.boundaryEnabled ? kBoundaryEnabled : 0u) |
+                   (engine.sleepingEnabled ? kSleepingEnabled : 0u);
+    header.gravity[0] = engine.getGravity().x;
+    header.gravity[1] = engine.getGravity().y;
+    header.bounds[0] = engine.getBounds().x;
+    header.bounds[1] = engine.getBounds().y;
+    header.airResistance = engine.airResistanceCoefficient;
+    header.sleepVelocity = engine.sleepVelocity;
+    header.timeToSleep = engine.timeToSleep;
+    header.wakeVelocity = engine.wakeVelocity;
+    const BarnesHutGravity& tree = engine.getMutualGravity();
+    header.gravitationalConstant = tree.gravitationalConstant;
+    header.theta = tree.theta;
+    header.softening = tree.softening;
+    header.leafSize = static_cast<std::uint32_t>(tree.leafSize);
+    header.integrationMethod = static_cast<std::uint8_t>(engine.getIntegrationMethod());
+    header.broadphaseMethod = static_cast<std::uint8_t>(engine.getBroadphaseMethod());
+    header.gravityMode = static_cast<std::uint8_t>(engine.getGravityMode());
+
+    const std::string tempPath = path + ".tmp";
+    std::FILE* file = std::fopen(tempPath.c_str(), "wb");
+    if (!file) return false;
+
+    bool ok = std::fwrite(&header, sizeof(Header), 1, file) == 1;
+    for (const OutputField& field : fields) {
+        ok = ok && std::fwrite(&field.entry, sizeof(FieldEntry), 1, file) == 1;
+    }
+    size_t written = sizeof(Header) + fields.size() * sizeof(FieldEntry);
+    static const char padding[kCacheLineSize] = {};
+    for (const OutputField& field : fields) {
+        size_t gap = static_cast<size_t>(field.entry.offset) - written;
+        size_t size = static_cast<size_t>(field.entry.size);
+        ok = ok && std::fwrite(padding, 1, gap, file) == gap;
+        if (size > 0) {
+            ok = ok && std::fwrite(field.data, 1, size, file) == size;
+        }
+        written += gap + size;
+    }
+    ok = std::fclose(file) == 0 && ok;
+
+    std::error_code error;
+    if (ok) {
+        std::filesystem::rename(tempPath, path, error);
+    }
+    if (!ok || error) {
+        std::remove(tempPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool loadWorldSnapshot(PhysicsEngine& engine, const std::string& path) {
+    MappedFile file;
+    SnapshotReader reader;
+    if (!file.open(path) || !reader.open(file)) return false;
+
+    const Header& header = reader.getHeader();
+    const size_t count = static_cast<size_t>(header.bodyCount);
+    const Vector2D* position = reader.findPerBody<Vector2D>(kPosition);
+    const Vector2D* velocity = reader.findPerBody<Vector2D>(kVelocity);
+    const Vector2D* force = reader.findPerBody<Vector2D>(kForce);
+    const Vector2D* previousPosition = reader.findPerBody<Vector2D>(kPreviousPosition);
+    const float* invMass = reader.findPerBody<float>(kInvMass);
+    const float* radius = reader.findPerBody<float>(kRadius);
+    const float* restitution = reader.findPerBody<float>(kRestitution);
+    const float* mass = reader.findPerBody<float>(kMass);
+    const float* friction = reader.findPerBody<float>(kFriction);
+    const Vector2D* extents = reader.findPerBody<Vector2D>(kExtents);
+    const ShapeType* shape = reader.findPerBody<ShapeType>(kShape);
+    const BodyMotion* motion = reader.findPerBody<BodyMotion>(kMotion);
+    const Vector2D* sleepAnchor = reader.findPerBody<Vector2D>(kSleepAnchor);
+    const float* sleepTimer = reader.findPerBody<float>(kSleepTimer);
+    const std::uint32_t* sleepIsland = reader.findPerBody<std::uint32_t>(kSleepIsland);
+    const std::uint8_t* bullet = reader.findPerBody<std::uint8_t>(kBullet);  // Optional, added later
+    size_t xpbdCount = 0;
+    const XpbdSettings* xpbd = reader.find<XpbdSettings>(kXpbdSettings, xpbdCount);  // Optional, added later
+    if (!position || !velocity || !force || !previousPosition || !invMass || !radius || !restitution ||
+        !mass || !friction || !extents || !shape || !motion || !sleepAnchor || !sleepTimer || !sleepIsland) {
+        return false;
+    }
+
+    size_t colorCount = 0, offsetCount = 0, charCount = 0;
+    const float* colors = reader.find<float>(kColor, colorCount);
+    const std::uint64_t* labelOffsets = reader.find<std::uint64_t>(kLabelOffsets, offsetCount);
+    const char* labelChars = reader.find<char>(kLabelChars, charCount);
+    if (!colors || colorCount != count * 3 || !labelOffsets || offsetCount != count + 1 || !labelChars) {
+        return false;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        if (labelOffsets[i] > labelOffsets[i + 1]) return false;
+    }
+    if (labelOffsets[count] > charCount) return false;
+    for (size_t i = 0; i < count; ++i) {
+        if (static_cast<unsigned>(shape[i]) > static_cast<unsigned>(ShapeType::Box) ||
+            motion[i] > BodyMotion::Sleeping) {
+            return false;
+        }
+    }
+
+    // The file is sound; replace the engine's state
+    engine.clearObjects();
+    engine.clearForceFields();
+    addFields<UniformField>(engine, reader, kUniformFields);
+    addFields<RadialField>(engine, reader, kRadialFields);
+    addFields<VortexField>(engine, reader, kVortexFields);
+    addFields<SpringField>(engine, reader, kSpringFields);
+
+    engine.gravityEnabled = header.flags & kGravityEnabled;
+    engine.collisionsEnabled = header.flags & kCollisionsEnabled;
+    engine.boundaryEnabled = header.flags & kBoundaryEnabled;
+    engine.sleepingEnabled = header.flags & kSleepingEnabled;
+    engine.setGravity(Vector2D(header.gravity[0], header.gravity[1]));
+    engine.setBounds(header.bounds[0], header.bounds[1]);
+    engine.airResistanceCoefficient = header.airResistance;
+    engine.sleepVelocity = header.sleepVelocity;
+    engine.timeToSleep = header.timeToSleep;
+    engine.wakeVelocity = header.wakeVelocity;
+    BarnesHutGravity& tree = engine.getMutualGravity();
+    tree.gravitationalConstant = header.gravitationalConstant;
+    tree.theta = header.theta;
+    tree.softening = header.softening;
+    tree.leafSize = header.leafSize;
+    engine.setIntegrationMethod(static_cast<IntegrationMethod>(header.integrationMethod));
+    engine.setBroadphaseMethod(static_cast<BroadphaseMethod>(header.broadphaseMethod));
+    engine.setGravityMode(static_cast<GravityMode>(header.gravityMode));
+    // Files from before the settings were saved get the defaults
+    XpbdSolver& solver = engine.getXpbdSolver();
+    const XpbdSolver defaults;
+    solver.substeps = xpbd && xpbdCount == 1 ? xpbd->substeps : defaults.substeps;
+    solver.contactCompliance = xpbd && xpbdCount == 1 ? xpbd->contactCompliance : defaults.contactCompliance;
+    solver.wallCompliance = xpbd && xpbdCount == 1 ? xpbd->wallCompliance : defaults.wallCompliance;
+
+    BodyStorage& bodies = engine.getBodies();
+    adopt(bodies.position, position, count);
+    adopt(bodies.velocity, velocity, count);
+    adopt(bodies.force, force, count);
+    adopt(bodies.previousPosition, previousPosition, count);
+    adopt(bodies.invMass, invMass, count);
+    adopt(bodies.radius, radius, count);
+    adopt(bodies.restitution, restitution, count);
+    adopt(bodies.mass, mass, count);
+    adopt(bodies.friction, friction, count);
+    adopt(bodies.extents, extents, count);
+    adopt(bodies.shape, shape, count);
+    adopt(bodies.motion, motion, count);
+    adopt(bodies.sleepAnchor, sleepAnchor, count);
+    adopt(bodies.sleepTimer, sleepTimer, count);
+    adopt(bodies.sleepIsland, sleepIsland, count);
+    if (bullet) {
+        adopt(bodies.bullet, bullet, count);
+    } else {
+        bodies.bullet.assign(count, 0);
+    }
+
+    bodies.appearance.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        BodyAppearance& look = bodies.appearance[i];
+        look.colorR = colors[i * 3 + 0];
+        look.colorG = colors[i * 3 + 1];
+        look.colorB = colors[i * 3 + 2];
+        look.label.assign(labelChars + labelOffsets[i], static_cast<size_t>(labelOffsets[i + 1] - labelOffsets[i]));
+    }
+
+    engine.resyncBodies();
+    engine.setStepCount(header.stepCount);
+    return true;
+}
+
+} // namespace Physica
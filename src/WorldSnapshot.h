@@ -0,0 +1,23 @@
+#pragma once
+#include "PhysicsEngine.h"
+#include <string>
+
+namespace Physica {
+
+// Versioned binary checkpoints of a whole engine: bodies, force fields and
+// parameters. The file is a fixed header, a table of fields and then one
+// contiguous array per body field (positions, velocities, masses, ...),
+// each starting on a cache line boundary. Saving is one bulk write per
+// array. Loading maps the file and copies each array straight into the
+// engine's storage, with no per-body parsing except labels. Files are
+// native-endian; a file from a machine of the other byte order, or from
+// another format version, is rejected.
+//
+// Both return false on I/O errors or invalid files. Saving writes to
+// `path`.tmp and renames it, so an interrupted save never leaves a torn
+// file. The whole file is checked before the engine is touched, so a
+// failed load leaves it as it was.
+bool saveWorldSnapshot(const PhysicsEngine& engine, const std::string& path);
+bool loadWorldSnapshot(PhysicsEngine& engine, const std::string& path);
+
+} // namespace Physica
@@ -0,0 +1,121 @@
+#include "XpbdSolver.h"
+#include "Collision.h"
+#include <algorithm>
+
+namespace Physica {
+
+namespace {
+
+// Separating normal speed after a constraint is hit at `approach` (negative
+// when closing): the restitution share of it, or nothing for a resting hit
+float bounce(float approach, float restitution, float restingSpeed) {
+    return -approach > restingSpeed ? -restitution * approach : 0.0f;
+}
+
+} // namespace
+
+void XpbdSolver::gatherPairs(const BodyStorage& bodies, const std::vector<BodyPair>& candidates, float margin) {
+    // finishBodies leaves every correction at zero
+    corrections.resize(bodies.size());
+    pairs.clear();
+    for (const BodyPair& pair : candidates) {
+        float reach = bodies.boundingRadius(pair.a) + bodies.boundingRadius(pair.b) + margin;
+        if ((bodies.position[pair.b] - bodies.position[pair.a]).magnitudeSquared() < reach * reach) {
+            pairs.push_back(pair);
+        }
+    }
+}
+
+void XpbdSolver::solveContacts(BodyStorage& bodies, float h) {
+    const float alpha = contactCompliance / (h * h);
+    active.clear();
+    contacts.clear();
+    for (const BodyPair& pair : pairs) {
+        const float invMassA = bodies.invMass[pair.a];
+        const float invMassB = bodies.invMass[pair.b];
+        const float totalInvMass = invMassA + invMassB;
+        if (totalInvMass == 0.0f) continue;  // Both static or asleep
+
+        Vector2D normal;
+        float penetration;
+        if (!computeContact(bodies, pair.a, pair.b, normal, penetration)) continue;
+
+        const float approach = (bodies.velocity[pair.b] - bodies.velocity[pair.a]).dot(normal);
+        const Vector2D correction = normal * (penetration / (totalInvMass + alpha));
+        if (invMassA != 0.0f) {
+            bodies.position[pair.a] -= correction * invMassA;
+            corrections[pair.a] -= correction * invMassA;
+        }
+        if (invMassB != 0.0f) {
+            bodies.position[pair.b] += correction * invMassB;
+            corrections[pair.b] += correction * invMassB;
+        }
+        active.push_back({pair.a, pair.b, normal, approach});
+        contacts.push_back(pair);
+    }
+}
+
+void XpbdSolver::finishBodies(BodyStorage& bodies, size_t begin, size_t end, bool walls, const Vector2D& bounds,
+                              float h, float restingSpeed) {
+    const float alpha = wallCompliance / (h * h);
+    const float invH = 1.0f / h;
+    for (size_t i = begin; i < end; ++i) {
+        const float invMass = bodies.invMass[i];
+        if (invMass == 0.0f) continue;
+
+        Vector2D& position = bodies.position[i];
+        const Vector2D predicted = bodies.velocity[i];
+        Vector2D moved = corrections[i];  // By this substep's projections
+        corrections[i] = Vector2D(0, 0);
+        int wallX = 0;  // -1 or 1 when held by the left or right wall
+        int wallY = 0;
+        if (walls) {
+            const Vector2D half = bodies.halfExtents(i);
+            const float give = invMass / (invMass + alpha);
+            Vector2D push(0, 0);
+            if (position.x - half.x < 0.0f) {
+                push.x = (half.x - position.x) * give;
+                wallX = -1;
+            } else if (position.x + half.x > bounds.x) {
+                push.x = (bounds.x - position.x - half.x) * give;
+                wallX = 1;
+            }
+            if (position.y - half.y < 0.0f) {
+                push.y = (half.y - position.y) * give;
+                wallY = -1;
+            } else if (position.y + half.y > bounds.y) {
+                push.y = (bounds.y - position.y - half.y) * give;
+                wallY = 1;
+            }
+            position += push;
+            moved += push;
+        }
+
+        Vector2D velocity = predicted + moved * invH;
+        // A wall's normal points back into the box, along -wallX or -wallY
+        const float restitution = bodies.restitution[i];
+        if (wallX != 0) {
+            velocity.x = -wallX * bounce(-wallX * predicted.x, restitution, restingSpeed);
+        }
+        if (wallY != 0) {
+            velocity.y = -wallY * bounce(-wallY * predicted.y, restitution, restingSpeed);
+        }
+        bodies.velocity[i] = velocity;
+    }
+}
+
+void XpbdSolver::solveVelocities(BodyStorage& bodies, float restingSpeed) const {
+    for (const Contact& contact : active) {
+        const float invMassA = bodies.invMass[contact.a];
+        const float invMassB = bodies.invMass[contact.b];
+        const float restitution = std::min(bodies.restitution[contact.a], bodies.restitution[contact.b]);
+        const float normalSpeed = (bodies.velocity[contact.b] - bodies.velocity[contact.a]).dot(contact.normal);
+        const float target = bounce(contact.approach, restitution, restingSpeed);
+
+        const Vector2D impulse = contact.normal * ((target - normalSpeed) / (invMassA + invMassB));
+        if (invMassA != 0.0f) bodies.velocity[contact.a] -= impulse * invMassA;
+        if (invMassB != 0.0f) bodies.velocity[contact.b] += impulse * invMassB;
+    }
+}
+
+} // namespace Physica
@@ -0,0 +1,68 @@
+#pragma once
+#include "BodyStorage.h"
+#include "Broadphase.h"
+#include <cstdint>
+#include <vector>
+
+namespace Physica {
+
+// Constraints for the substepped extended position-based dynamics (XPBD)
+// integrator. A step of length dt runs `substeps` substeps of length h:
+// bodies move to positions predicted from their velocity and forces
+// (semi-implicit Euler), every constraint is projected once, velocities
+// change by how far the projections moved the bodies, and a last pass sets
+// the bounce of every constraint that was touched. (Taking velocities from
+// the whole move instead is the same in exact arithmetic, but in float it
+// loses most of the digits of a short substep's move far from the origin.)
+// Contacts and walls are constraints; joints would be more lists solved the
+// same way.
+//
+// Compliance is the inverse of a constraint's stiffness. Zero makes it
+// rigid; larger values let it give like a spring, by the same amount
+// whatever the substep count. Many short substeps of one projection each
+// converge better than one step with many solver iterations, so piles
+// rest without sinking or jittering at a full-size frame step.
+class XpbdSolver {
+public:
+    int substeps = 8;
+    float contactCompliance = 0.0f;  // pixels per unit of force
+    float wallCompliance = 0.0f;
+
+    // Keeps the candidate pairs whose bounding circles are less than
+    // `margin` apart, once per step: the pairs that can touch within it
+    void gatherPairs(const BodyStorage& bodies, const std::vector<BodyPair>& candidates, float margin);
+
+    // Projects every overlapping pair apart, in pair order, recording
+    // each contact's normal and approach speed for solveVelocities
+    void solveContacts(BodyStorage& bodies, float h);
+
+    // Projects bodies [begin, end) inside the box from (0, 0) to `bounds`
+    // (when `walls` is set) and adds the substep's projections to their
+    // velocity. Approaches slower than restingSpeed (about twice what
+    // gravity adds in a substep) stop instead of bouncing, so resting
+    // bodies stay put.
+    void finishBodies(BodyStorage& bodies, size_t begin, size_t end, bool walls, const Vector2D& bounds,
+                      float h, float restingSpeed);
+
+    // Sets the normal speed of every contact solveContacts touched: a
+    // bounce with the pair's restitution, or none for a resting contact
+    void solveVelocities(BodyStorage& bodies, float restingSpeed) const;
+
+    const std::vector<BodyPair>& getPairs() const { return pairs; }
+    // Pairs that touched in the last solveContacts
+    const std::vector<BodyPair>& getContacts() const { return contacts; }
+
+private:
+    struct Contact {
+        std::uint32_t a, b;
+        Vector2D normal;  // From a to b
+        float approach;   // Normal speed before the substep's projection
+    };
+
+    std::vector<BodyPair> pairs;
+    std::vector<Contact> active;
+    std::vector<BodyPair> contacts;
+    std::vector<Vector2D> corrections;  // Per body, how far this substep's contacts moved it
+};
+
+} // namespace Physica
@@ -0,0 +1,85 @@
+// Barnes-Hut forces against the exact pairwise sum. At a large opening
+// angle nodes close to a body are accepted as point masses, including the
+// nodes that hold the body itself, which must be opened instead.
+#include "BarnesHutGravity.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+using namespace Physica;
+
+namespace {
+
+bool check(bool condition, const char* what) {
+    std::printf("%-60s %s\n", what, condition ? "ok" : "FAILED");
+    return condition;
+}
+
+struct Errors {
+    double rms = 0.0;    // RMS force error over RMS exact force
+    double worst = 0.0;  // Worst relative error of one body
+};
+
+Errors measure(float theta, const BodyStorage& initial, ThreadPool& pool) {
+    BodyStorage bodies = initial;
+    BarnesHutGravity gravity;
+    gravity.theta = theta;
+    gravity.leafSize = 1;
+    gravity.apply(bodies, pool);
+
+    Errors errors;
+    double errorSquared = 0.0;
+    double forceSquared = 0.0;
+    for (size_t i = 0; i < bodies.size(); ++i) {
+        Vector2D exact = gravity.directForce(bodies, i);
+        Vector2D error = bodies.force[i] - exact;
+        errorSquared += error.magnitudeSquared();
+        forceSquared += exact.magnitudeSquared();
+        errors.worst = std::max(errors.worst, static_cast<double>(error.magnitude() / exact.magnitude()));
+    }
+    errors.rms = std::sqrt(errorSquared / forceSquared);
+    return errors;
+}
+
+// A light body in one corner and eight heavier ones in the opposite corner:
+// the root's center of mass is far enough from the light body for theta 1
+// to accept the root, which holds the light body itself
+BodyStorage buildCluster() {
+    BodyStorage bodies;
+    bodies.add(PhysicsObject(Vector2D(0.0f, 0.0f), 2.5f));
+    for (int i = 0; i < 8; ++i) {
+        bodies.add(PhysicsObject(Vector2D(100.0f - 4.0f * (i % 3), 100.0f - 4.0f * (i / 3)), 1.0f));
+    }
+    return bodies;
+}
+
+BodyStorage buildDisc(size_t count) {
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<float> unit(0.0001f, 1.0f);
+    BodyStorage bodies;
+    for (size_t i = 0; i < count; ++i) {
+        float r = -500.0f * std::log(unit(rng));
+        float angle = 6.2831853f * unit(rng);
+        bodies.add(PhysicsObject(Vector2D(r * std::cos(angle), r * std::sin(angle)), 1.0f + i % 4));
+    }
+    return bodies;
+}
+
+} // namespace
+
+int main() {
+    ThreadPool pool(4);
+    const BodyStorage cluster = buildCluster();
+    const BodyStorage disc = buildDisc(2000);
+    const Errors clusterHalf = measure(0.5f, cluster, pool);
+    const Errors clusterOne = measure(1.0f, cluster, pool);
+    const Errors discOne = measure(1.0f, disc, pool);
+    std::printf("worst body error: cluster %g at theta 0.5, %g at theta 1; disc rms error %g at theta 1\n",
+                clusterHalf.worst, clusterOne.worst, discOne.rms);
+    // Pulled by its own mass the light body is off by more than 100%
+    bool ok = check(clusterHalf.worst <= 0.01, "cluster at theta 0.5 within 1% of the exact sum");
+    ok &= check(clusterOne.worst <= 0.2, "cluster at theta 1 within 20% of the exact sum");
+    ok &= check(discOne.rms <= 0.05, "disc at theta 1 within 5% rms of the exact sum");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,194 @@
+// Colour-batched contact resolution against the serial solver.
+// Where no two contacts share a dynamic body, resolution order cannot
+// matter, so batches must reproduce solveSerial body for body; this covers
+// the colouring, static bodies and the overflow batch. In a packed pile one
+// pass of pairwise impulses depends on the order, so batches and serial
+// differ body by body and are compared on what both must conserve instead.
+// Finally the engine must give the same world whatever its thread count.
+#include "Broadphase.h"
+#include "ContactSolver.h"
+#include "PhysicsEngine.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+
+using namespace Physica;
+
+namespace {
+
+constexpr float kTolerance = 1e-4f;
+
+bool check(bool condition, const char* what) {
+    std::printf("%-60s %s\n", what, condition ? "ok" : "FAILED");
+    return condition;
+}
+
+void addBody(BodyStorage& bodies, const Vector2D& position, float radius, float mass, const Vector2D& velocity,
+             bool isStatic = false) {
+    PhysicsObject obj(position, mass);
+    obj.radius = radius;
+    obj.velocity = velocity;
+    obj.isStatic = isStatic;
+    bodies.add(obj);
+}
+
+// Overlapping pairs, bodies resting on static posts, and one hub touched
+// by more bodies than there are colours, so the overflow batch is used
+BodyStorage buildIndependent() {
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> speed(-30.0f, 30.0f);
+    BodyStorage bodies;
+    for (int i = 0; i < 200; ++i) {
+        Vector2D at(40.0f * i, 0.0f);
+        addBody(bodies, at, 5.0f, 1.0f + i % 3, Vector2D(speed(rng), speed(rng)));
+        addBody(bodies, at + Vector2D(9.0f, 1.0f), 5.0f, 2.0f, Vector2D(speed(rng), speed(rng)));
+    }
+    for (int i = 0; i < 100; ++i) {
+        Vector2D at(40.0f * i, 100.0f);
+        addBody(bodies, at, 5.0f, 1.0f, Vector2D(0.0f, 0.0f), true);
+        addBody(bodies, at + Vector2D(0.0f, -9.0f), 5.0f, 1.0f, Vector2D(0.0f, speed(rng)));
+    }
+    const Vector2D hub(0.0f, 1000.0f);
+    addBody(bodies, hub, 150.0f, 50.0f, Vector2D(0.0f, 0.0f));
+    const int spokes = 70;
+    for (int i = 0; i < spokes; ++i) {
+        float angle = 6.2831853f * i / spokes;
+        Vector2D out(std::cos(angle), std::sin(angle));
+        addBody(bodies, hub + out * 154.0f, 5.0f, 1.0f, out * -20.0f);
+    }
+    return bodies;
+}
+
+// Hexagonal packing with slight overlap, about three contacts per body
+BodyStorage buildPile(size_t side) {
+    const float radius = 5.0f;
+    const float spacing = 1.9f * radius;
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> jitter(-20.0f, 20.0f);
+    BodyStorage bodies;
+    for (size_t row = 0; row < side; ++row) {
+        for (size_t col = 0; col < side; ++col) {
+            Vector2D at(col * spacing + (row % 2) * spacing * 0.5f, row * spacing * 0.866f);
+            addBody(bodies, at, radius, 1.0f + (col + row) % 5, Vector2D(jitter(rng), jitter(rng)));
+        }
+    }
+    return bodies;
+}
+
+void prepare(ContactSolver& solver, const BodyStorage& bodies, ThreadPool& pool) {
+    UniformGridBroadphase grid;
+    std::vector<BodyPair> candidates;
+    grid.findPairs(bodies, candidates);
+    solver.findContacts(bodies, candidates, pool);
+    solver.buildBatches(bodies);
+}
+
+float maxDifference(const BodyStorage& a, const BodyStorage& b) {
+    float diff = 0.0f;
+    for (size_t i = 0; i < a.size(); ++i) {
+        diff = std::max(diff, (a.position[i] - b.position[i]).magnitude());
+        diff = std::max(diff, (a.velocity[i] - b.velocity[i]).magnitude());
+    }
+    return diff;
+}
+
+Vector2D momentum(const BodyStorage& bodies) {
+    double x = 0.0, y = 0.0;
+    for (size_t i = 0; i < bodies.size(); ++i) {
+        x += double(bodies.mass[i]) * bodies.velocity[i].x;
+        y += double(bodies.mass[i]) * bodies.velocity[i].y;
+    }
+    return Vector2D(static_cast<float>(x), static_cast<float>(y));
+}
+
+double kineticEnergy(const BodyStorage& bodies) {
+    double total = 0.0;
+    for (size_t i = 0; i < bodies.size(); ++i) {
+        total += 0.5 * bodies.mass[i] * bodies.velocity[i].magnitudeSquared();
+    }
+    return total;
+}
+
+bool testIndependentContacts(ThreadPool& pool) {
+    const BodyStorage initial = buildIndependent();
+    ContactSolver solver;
+    prepare(solver, initial, pool);
+
+    BodyStorage serial = initial;
+    BodyStorage batched = initial;
+    solver.solveSerial(serial);
+    solver.solveBatches(batched, pool);
+    std::printf("independent: %zu contacts in %zu batches, max difference %g\n", solver.getContacts().size(),
+                solver.getBatchCount(), maxDifference(serial, batched));
+    bool ok = check(solver.getContacts().size() == 200 + 100 + 70, "every overlap found");
+    ok &= check(solver.getBatchCount() > 64, "hub contacts spill into the overflow batch");
+    ok &= check(maxDifference(serial, batched) <= kTolerance, "batches match serial body for body");
+    return ok;
+}
+
+bool testPile(ThreadPool& pool) {
+    const BodyStorage initial = buildPile(100);
+    ContactSolver solver;
+    prepare(solver, initial, pool);
+
+    BodyStorage serial = initial;
+    BodyStorage batched = initial;
+    solver.solveSerial(serial);
+    solver.solveBatches(batched, pool);
+
+    const Vector2D before = momentum(initial);
+    const float scale = std::sqrt(static_cast<float>(2.0 * kineticEnergy(initial) * initial.size()));
+    const float serialDrift = (momentum(serial) - before).magnitude() / scale;
+    const float batchedDrift = (momentum(batched) - before).magnitude() / scale;
+    std::printf("pile: %zu contacts in %zu batches, momentum drift %g serial, %g batched; "
+                "kinetic energy %.0f before, %.0f serial, %.0f batched\n",
+                solver.getContacts().size(), solver.getBatchCount(), serialDrift, batchedDrift,
+                kineticEnergy(initial), kineticEnergy(serial), kineticEnergy(batched));
+    bool ok = check(solver.getContacts().size() > 25000, "pile has enough contacts to exercise batches");
+    ok &= check(serialDrift <= kTolerance && batchedDrift <= kTolerance, "both conserve momentum");
+    ok &= check(kineticEnergy(batched) <= kineticEnergy(initial), "batches do not add energy");
+    // One pass removes a similar share of the energy in either order
+    const double removedSerial = kineticEnergy(initial) - kineticEnergy(serial);
+    const double removedBatched = kineticEnergy(initial) - kineticEnergy(batched);
+    ok &= check(std::fabs(removedBatched - removedSerial) <= 0.25 * removedSerial,
+                "batches remove energy like serial, within 25%");
+    return ok;
+}
+
+// A pile big enough to cross minParallelContacts, stepped with one thread
+// and with several
+bool testThreadCounts() {
+    auto run = [](size_t threads) {
+        PhysicsEngine engine;
+        engine.setThreadCount(threads);
+        engine.setBounds(1000.0f, 1000.0f);
+        engine.sleepingEnabled = false;
+        const BodyStorage pile = buildPile(60);
+        for (size_t i = 0; i < pile.size(); ++i) {
+            PhysicsObject obj = pile.toObject(i);
+            obj.position += Vector2D(100.0f, 100.0f);
+            engine.addObject(obj);
+        }
+        engine.step(10, 1.0f / 60.0f);
+        return engine.getBodies();
+    };
+    const BodyStorage one = run(1);
+    const BodyStorage four = run(4);
+    const size_t bytes = one.size() * sizeof(Vector2D);
+    bool same = one.size() == four.size() &&
+                std::memcmp(one.position.data(), four.position.data(), bytes) == 0 &&
+                std::memcmp(one.velocity.data(), four.velocity.data(), bytes) == 0;
+    return check(same, "engine steps the same with 1 and 4 threads");
+}
+
+} // namespace
+
+int main() {
+    ThreadPool pool(4);
+    bool ok = testIndependentContacts(pool);
+    ok &= testPile(pool);
+    ok &= testThreadCounts();
+    return ok ? 0 : 1;
+}